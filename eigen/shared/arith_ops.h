@@ -25,12 +25,14 @@
 
 #include "types.h"
 #include "utils.h"
+#include "diagonal.h"
+#include "simd_dispatch.h"
 
 //
 template<typename T, typename R, bool = IsXpr<T>::value> struct MatrixOps {
     static int Add (lua_State * L)
     {
-        if (HasType<T>(L, 1) && HasType<T>(L, 2)) return NewRet<R>(L, *LuaXS::UD<T>(L, 1) + *LuaXS::UD<T>(L, 2));
+        if (HasType<T>(L, 1) && HasType<T>(L, 2)) return detail_simd::Arith<T, R>::Add(L, *LuaXS::UD<T>(L, 1), *LuaXS::UD<T>(L, 2));
         else return MatrixOps<T, R, true>::Add(L);
     }
     
@@ -67,7 +69,7 @@ template<typename T, typename R, bool = IsXpr<T>::value> struct MatrixOps {
     
     static int Sub (lua_State * L)
     {
-        if (HasType<T>(L, 1) && HasType<T>(L, 2)) return NewRet<R>(L, *LuaXS::UD<T>(L, 1) - *LuaXS::UD<T>(L, 2));
+        if (HasType<T>(L, 1) && HasType<T>(L, 2)) return detail_simd::Arith<T, R>::Sub(L, *LuaXS::UD<T>(L, 1), *LuaXS::UD<T>(L, 2));
         else return MatrixOps<T, R, true>::Sub(L);
     }
 };
@@ -82,6 +84,8 @@ template<typename T, typename R> struct MatrixOps<T, R, true> {
     
     static int Mul (lua_State * L)
     {
+        if (detail_diag::HasDiagonal<R>(L)) return detail_diag::Product<R>(L);
+
         return NewRet<R>(L, WithMatrixScalarCombination<R>(L, [](const R & m1, const R & m2) {
             return m1 * m2;
         }, [](const R & m, const typename T::Scalar & s) {
@@ -0,0 +1,271 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "macros.h"
+#include "types.h"
+#include "utils.h"
+
+// Key to the sentinel whose collection joins any orphaned workers.
+#define EIGEN_ASYNC_WORKERS_KEY "EIGEN::ASYNC_WORKERS"
+
+// Workers whose handles were collected before they finished. Rather than outliving the code they
+// run, these are joined when any state using them closes, or failing that once the library is
+// unloaded. Finished ones are reaped along the way.
+struct AsyncWorkers {
+	std::mutex mMutex;	// Guards the list, which any state's Lua thread may touch
+	std::vector<std::pair<std::thread, std::function<bool (void)>>> mWorkers;	// Orphaned workers and readiness tests
+
+	~AsyncWorkers (void)
+	{
+		JoinAll();
+	}
+
+	static AsyncWorkers & Get (void)
+	{
+		static AsyncWorkers sWorkers;
+
+		return sWorkers;
+	}
+
+	// Ensure the state joins the workers when closed.
+	static void BindToState (lua_State * L)
+	{
+		lua_getfield(L, LUA_REGISTRYINDEX, EIGEN_ASYNC_WORKERS_KEY);// ..., sentinel?
+
+		if (lua_isnil(L, -1))
+		{
+			lua_newuserdata(L, 1U);	// ..., nil, sentinel
+			lua_createtable(L, 0, 1);	// ..., nil, sentinel, meta
+			lua_pushcfunction(L, [](lua_State *) {
+				Get().JoinAll();
+
+				return 0;
+			});	// ..., nil, sentinel, meta, GC
+			lua_setfield(L, -2, "__gc");// ..., nil, sentinel, meta = { __gc = GC }
+			lua_setmetatable(L, -2);// ..., nil, sentinel
+			lua_setfield(L, LUA_REGISTRYINDEX, EIGEN_ASYNC_WORKERS_KEY);// ..., nil; registry = { ..., ASYNC_WORKERS_KEY = sentinel }
+		}
+
+		lua_pop(L, 1);	// ...
+	}
+
+	void Adopt (std::thread && worker, std::function<bool (void)> ready)
+	{
+		std::lock_guard<std::mutex> lock{mMutex};
+
+		for (auto iter = mWorkers.begin(); iter != mWorkers.end(); )
+		{
+			if (iter->second())
+			{
+				iter->first.join();
+
+				iter = mWorkers.erase(iter);
+			}
+
+			else ++iter;
+		}
+
+		mWorkers.emplace_back(std::move(worker), std::move(ready));
+	}
+
+	void JoinAll (void)
+	{
+		std::lock_guard<std::mutex> lock{mMutex};
+
+		for (auto & entry : mWorkers) entry.first.join();
+
+		mWorkers.clear();
+	}
+};
+
+// Decomposition computed on a worker thread. Its inputs are copied on creation, so the source
+// matrices may be modified or collected in the meantime. The worker only touches these copies
+// and the result; all Lua access stays on the creating thread, which either polls the handle or
+// blocks on it, then takes delivery of an ordinary solver object. Inputs are validated up front,
+// but any assert that still fails on the worker is thrown and caught there, to be reported once
+// waited on.
+template<typename S> struct AsyncDecomposition {
+	using MatrixType = typename S::MatrixType;
+	using Scalar = typename MatrixType::Scalar;
+	using Compute = std::function<S * (const MatrixType &, const MatrixType &)>;
+
+	// State shared with the worker, which keeps it alive should the handle be collected first.
+	struct Job {
+		MatrixType mA, mB;	// Copies of the inputs; the second is only used by generalized problems
+		std::unique_ptr<S> mResult;	// Decomposition, once computed
+		std::string mError;	// Once ready, any message means failure
+		std::atomic<bool> mReady{false};// Has the worker finished?
+	};
+
+	std::shared_ptr<Job> mJob;	// Work in progress, or its outcome
+	std::thread mWorker;// Thread running the decomposition
+	bool mDelivered{false};	// Has the result been handed over to Lua?
+
+	AsyncDecomposition (MatrixType && a, MatrixType && b, Compute compute) : mJob{std::make_shared<Job>()}
+	{
+		mJob->mA = std::move(a);
+		mJob->mB = std::move(b);
+
+		std::shared_ptr<Job> job = mJob;
+
+		mWorker = std::thread{[job, compute]() {
+			tls_OnWorker = true;
+
+			try {
+				job->mResult.reset(compute(job->mA, job->mB));
+			} catch (std::exception & ex) {
+				job->mError = ex.what();
+			}
+
+			tls_OnWorker = false;
+
+			job->mA.resize(0, 0);
+			job->mB.resize(0, 0);
+
+			job->mReady.store(true, std::memory_order_release);
+		}};
+	}
+
+	// Collection may happen at any time, e.g. during a collector step, so rather than stalling the
+	// Lua thread an unfinished worker is handed off, to be joined later.
+	~AsyncDecomposition (void)
+	{
+		if (mWorker.joinable())
+		{
+			if (isReady()) mWorker.join();
+
+			else
+			{
+				std::shared_ptr<Job> job = mJob;
+
+				AsyncWorkers::Get().Adopt(std::move(mWorker), [job]() {
+					return job->mReady.load(std::memory_order_acquire);
+				});
+			}
+		}
+	}
+
+	bool isReady (void) const { return mJob->mReady.load(std::memory_order_acquire); }
+
+	void wait (void)
+	{
+		if (mWorker.joinable()) mWorker.join();
+	}
+};
+
+/*****************************
+* AsyncDecomposition methods *
+*****************************/
+template<typename S, typename R> struct AttachMethods<AsyncDecomposition<S>, R> {
+	using Getters = InstanceGetters<AsyncDecomposition<S>, R>;
+
+	// Block until the worker is done, raising any error that it ran into.
+	static AsyncDecomposition<S> & Finish (lua_State * L)
+	{
+		AsyncDecomposition<S> & async = *Getters::GetT(L);
+
+		async.wait();
+
+		if (!async.mJob->mError.empty()) luaL_error(L, "Decomposition failed: %s", async.mJob->mError.c_str());
+
+		return async;
+	}
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(isReady)
+			}, {
+				// Block until the decomposition is available, then supply it as the solver type the
+				// synchronous factory would produce. The same solver is returned on later calls.
+				"result", [](lua_State * L)
+				{
+					AsyncDecomposition<S> & async = Finish(L);
+
+					if (async.mDelivered) return TypeData<AsyncDecomposition<S>>::Get(L)->GetRef(L, "async_result", 1);	// async, solver
+
+					lua_settop(L, 1);	// async
+
+					New<S>(L, std::move(*async.mJob->mResult));	// async, solver
+
+					async.mJob->mResult.reset();
+
+					TypeData<AsyncDecomposition<S>>::Get(L)->RefAt(L, "async_result", 2, 1);
+
+					async.mDelivered = true;
+
+					return 1;
+				}
+			}, {
+				"wait", [](lua_State * L)
+				{
+					Finish(L);
+
+					return SelfForChaining(L);	// async, async
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+template<typename S> struct AuxTypeName<AsyncDecomposition<S>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "AsyncDecomposition<");
+
+		AuxTypeName<S>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
+
+// Requirements on the inputs of an asynchronous decomposition, checked before launch.
+enum AsyncInputs { eAnyShape, eSquare, eSquarePair };
+
+// Launch a decomposition of the matrix at index 1 and, for generalized problems, another one at
+// index 2, pushing its handle.
+template<typename S, typename T, typename R> int LaunchAsync (lua_State * L, typename AsyncDecomposition<S>::Compute compute, AsyncInputs inputs = eAnyShape)
+{
+	R a = *GetInstance<T>(L, 1), b;
+
+	if (inputs != eAnyShape) luaL_argcheck(L, a.rows() == a.cols(), 1, "Decomposition requires a square matrix");
+
+	if (inputs == eSquarePair)
+	{
+		b = GetInstanceEx<R>(L, 2);
+
+		luaL_argcheck(L, b.rows() == a.rows() && b.cols() == a.cols(), 2, "Matrices must have the same dimensions");
+	}
+
+	AsyncWorkers::BindToState(L);
+
+	New<AsyncDecomposition<S>>(L, std::move(a), std::move(b), std::move(compute));	// a[, b], ..., async
+
+	return 1;
+}
@@ -0,0 +1,500 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+
+// Boolean matrix stored one bit per element, in the same column-major order as BoolMatrix. Bits
+// past the last element are kept clear, so whole words may be combined and counted as is.
+struct BitMatrix {
+	using Scalar = bool;// Belongs to the BoolMatrix family
+	using Word = uint64_t;
+
+	enum { kWordBits = 64 };
+
+	std::vector<Word> mWords;
+	Eigen::Index mRows{0}, mCols{0};
+
+	static size_t WordCount (Eigen::Index n) { return size_t((n + kWordBits - 1) / kWordBits); }
+
+	BitMatrix (void) = default;
+	BitMatrix (Eigen::Index rows, Eigen::Index cols) : mWords(WordCount(rows * cols), 0), mRows{rows}, mCols{cols}
+	{
+	}
+
+	// Pack a boolean matrix or expression, e.g. the result of a comparison, a word at a time.
+	template<typename D> explicit BitMatrix (const Eigen::DenseBase<D> & mask) : BitMatrix{mask.rows(), mask.cols()}
+	{
+		const D & m = mask.derived();
+		Word word = 0;
+		Eigen::Index k = 0;
+
+		for (Eigen::Index j = 0; j < mCols; ++j)
+		{
+			for (Eigen::Index i = 0; i < mRows; ++i, ++k)
+			{
+				word |= Word(m.coeff(i, j) ? 1 : 0) << (k % kWordBits);
+
+				if (k % kWordBits == kWordBits - 1)
+				{
+					mWords[size_t(k / kWordBits)] = word;
+					word = 0;
+				}
+			}
+		}
+
+		if (k % kWordBits) mWords.back() = word;
+	}
+
+	Eigen::Index rows (void) const { return mRows; }
+	Eigen::Index cols (void) const { return mCols; }
+	Eigen::Index size (void) const { return mRows * mCols; }
+
+	bool operator () (Eigen::Index i, Eigen::Index j) const
+	{
+		Eigen::Index k = j * mRows + i;
+
+		return (mWords[size_t(k / kWordBits)] >> (k % kWordBits)) & 1;
+	}
+
+	void setCoeff (Eigen::Index i, Eigen::Index j, bool value)
+	{
+		Eigen::Index k = j * mRows + i;
+		Word & word = mWords[size_t(k / kWordBits)];
+		Word bit = Word(1) << (k % kWordBits);
+
+		word = value ? word | bit : word & ~bit;
+	}
+
+	// Mask of the bits in use by the final word.
+	Word TailMask (void) const
+	{
+		int used = int(size() % kWordBits);
+
+		return used ? (Word(1) << used) - 1 : ~Word(0);
+	}
+
+	void ClearPadding (void)
+	{
+		if (!mWords.empty()) mWords.back() &= TailMask();
+	}
+
+	void setConstant (bool value)
+	{
+		std::fill(mWords.begin(), mWords.end(), value ? ~Word(0) : Word(0));
+
+		ClearPadding();
+	}
+
+	static int PopCount (Word word)
+	{
+	#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcountll(word);
+	#else
+		word -= (word >> 1) & 0x5555555555555555ULL;
+		word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+		return int((word * 0x0101010101010101ULL) >> 56);
+	#endif
+	}
+
+	Eigen::Index count (void) const
+	{
+		Eigen::Index n = 0;
+
+		for (Word word : mWords) n += PopCount(word);
+
+		return n;
+	}
+
+	bool any (void) const
+	{
+		for (Word word : mWords)
+		{
+			if (word) return true;
+		}
+
+		return false;
+	}
+
+	bool all (void) const
+	{
+		for (size_t i = 0, n = mWords.size(); i < n; ++i)
+		{
+			if (mWords[i] != (i + 1 < n ? ~Word(0) : TailMask())) return false;
+		}
+
+		return true;
+	}
+
+	bool SameShape (const BitMatrix & other) const
+	{
+		return mRows == other.mRows && mCols == other.mCols;
+	}
+
+	bool operator == (const BitMatrix & other) const
+	{
+		return SameShape(other) && mWords == other.mWords;
+	}
+
+	BitMatrix & operator &= (const BitMatrix & other)
+	{
+		for (size_t i = 0; i < mWords.size(); ++i) mWords[i] &= other.mWords[i];
+
+		return *this;
+	}
+
+	BitMatrix & operator |= (const BitMatrix & other)
+	{
+		for (size_t i = 0; i < mWords.size(); ++i) mWords[i] |= other.mWords[i];
+
+		return *this;
+	}
+
+	BitMatrix & operator ^= (const BitMatrix & other)
+	{
+		for (size_t i = 0; i < mWords.size(); ++i) mWords[i] ^= other.mWords[i];
+
+		return *this;
+	}
+
+	void flip (void)
+	{
+		for (Word & word : mWords) word = ~word;
+
+		ClearPadding();
+	}
+
+	// Choose coefficients from either operand, in the manner of DenseBase::select(). A word whose
+	// bits all agree chooses a whole run from one operand, copied a column piece at a time.
+	template<typename A, typename B> MatrixOf<typename A::Scalar> select (const Eigen::DenseBase<A> & a, const Eigen::DenseBase<B> & b) const
+	{
+		MatrixOf<typename A::Scalar> out{mRows, mCols};
+		Eigen::Index i = 0, j = 0;
+
+		for (Eigen::Index k = 0, n = size(); k < n; k += kWordBits)
+		{
+			Eigen::Index count = (std::min)(Eigen::Index(kWordBits), n - k);
+			Word word = mWords[size_t(k / kWordBits)];
+
+			if (word == 0 || word == (count < kWordBits ? (Word(1) << count) - 1 : ~Word(0)))
+			{
+				for (Eigen::Index left = count; left; )
+				{
+					Eigen::Index len = (std::min)(mRows - i, left);
+
+					if (word) out.col(j).segment(i, len) = a.derived().col(j).segment(i, len);
+					else out.col(j).segment(i, len) = b.derived().col(j).segment(i, len);
+
+					left -= len;
+					i += len;
+
+					if (i == mRows) i = 0, ++j;
+				}
+			}
+
+			else
+			{
+				for (Eigen::Index left = count; left; --left, word >>= 1)
+				{
+					out(i, j) = (word & 1) ? a.derived().coeff(i, j) : b.derived().coeff(i, j);
+
+					if (++i == mRows) i = 0, ++j;
+				}
+			}
+		}
+
+		return out;
+	}
+
+	BoolMatrix unpacked (void) const
+	{
+		BoolMatrix m{mRows, mCols};
+		bool * out = m.data();
+
+		for (Eigen::Index k = 0, n = size(); k < n; ++k) out[k] = (mWords[size_t(k / kWordBits)] >> (k % kWordBits)) & 1;
+
+		return m;
+	}
+};
+
+// Bit matrices resolve to BoolMatrix through their own "asMatrix" method.
+template<> struct IsConvertibleToMatrix<BitMatrix, BoolMatrix> : std::true_type {};
+
+template<> struct AuxTypeName<BitMatrix> {
+	AuxTypeName (luaL_Buffer * B, lua_State *) { luaL_addstring(B, "BitMatrix"); }
+};
+
+template<> struct HeapBytes<BitMatrix> {
+	static size_t Get (const BitMatrix & bits) { return bits.mWords.capacity() * sizeof(BitMatrix::Word); }
+};
+
+// Push the result of a relational operation, packing it if requested.
+template<typename D> void NewMask (lua_State * L, const Eigen::DenseBase<D> & mask, bool bPacked)
+{
+	if (bPacked) New<BitMatrix>(L, mask);
+	else New<BoolMatrix>(L, mask);
+}
+
+//
+namespace detail_bits {
+	// Fetch a mask operand, packing it first if it is not already a bit matrix.
+	inline const BitMatrix & Operand (lua_State * L, int arg, BitMatrix & temp)
+	{
+		if (HasType<BitMatrix>(L, arg)) return *LuaXS::UD<BitMatrix>(L, arg);
+
+		temp = BitMatrix{*MatrixRef<BoolMatrix>{L, arg}};
+
+		return temp;
+	}
+
+	// Perform a word-wise operation, either in place or into a new bit matrix.
+	template<typename F> int Combine (lua_State * L, F && func, bool bInPlace)
+	{
+		BitMatrix temp, * bits = GetInstance<BitMatrix>(L, 1);
+		const BitMatrix & other = Operand(L, 2, temp);
+
+		luaL_argcheck(L, bits->SameShape(other), 2, "Mismatched mask dimensions");
+
+		if (bInPlace)
+		{
+			func(*bits, other);
+
+			return SelfForChaining(L);
+		}
+
+		else
+		{
+			BitMatrix result{*bits};
+
+			func(result, other);
+
+			return NewRet<BitMatrix>(L, std::move(result));
+		}
+	}
+
+	// Read a coefficient position, 1-based, as either (index) for vectors or (row, col), and
+	// check that it lies within the matrix. Returns the 0-based row and column.
+	inline std::pair<Eigen::Index, Eigen::Index> Position (lua_State * L, const BitMatrix & bits, bool bVector)
+	{
+		Eigen::Index a = LuaXS::Int(L, 2) - 1, i, j;
+
+		if (bVector)
+		{
+			CheckVector(L, bits, 1);
+			luaL_argcheck(L, a >= 0 && a < bits.size(), 2, "Index out of range");
+
+			i = bits.cols() == 1 ? a : 0;
+			j = bits.cols() == 1 ? 0 : a;
+		}
+
+		else
+		{
+			i = a;
+			j = LuaXS::Int(L, 3) - 1;
+
+			luaL_argcheck(L, i >= 0 && i < bits.rows(), 2, "Row out of range");
+			luaL_argcheck(L, j >= 0 && j < bits.cols(), 3, "Column out of range");
+		}
+
+		return std::make_pair(i, j);
+	}
+
+	inline void And (BitMatrix & bits, const BitMatrix & other) { bits &= other; }
+	inline void Or (BitMatrix & bits, const BitMatrix & other) { bits |= other; }
+	inline void Xor (BitMatrix & bits, const BitMatrix & other) { bits ^= other; }
+}
+
+//
+template<> struct AttachMethods<BitMatrix, BoolMatrix> {
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"all", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, GetInstance<BitMatrix>(L, 1)->all());
+				}
+			}, {
+				"any", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, GetInstance<BitMatrix>(L, 1)->any());
+				}
+			}, {
+				"asMatrix", [](lua_State * L)
+				{
+					auto td = TypeData<BoolMatrix>::Get(L);
+					BitMatrix & bits = *GetInstance<BitMatrix>(L, 1);
+
+					if (!td || !td->mDatum) return NewRet<BoolMatrix>(L, bits.unpacked());
+
+					else
+					{
+						*static_cast<BoolMatrix *>(td->mDatum) = bits.unpacked();
+
+						return 0;
+					}
+				}
+			}, {
+				"band", [](lua_State * L)
+				{
+					return detail_bits::Combine(L, detail_bits::And, false);
+				}
+			}, {
+				"bandInPlace", [](lua_State * L)
+				{
+					return detail_bits::Combine(L, detail_bits::And, true);
+				}
+			}, {
+				"bnot", [](lua_State * L)
+				{
+					BitMatrix result{*GetInstance<BitMatrix>(L, 1)};
+
+					result.flip();
+
+					return NewRet<BitMatrix>(L, std::move(result));
+				}
+			}, {
+				"bnotInPlace", [](lua_State * L)
+				{
+					GetInstance<BitMatrix>(L, 1)->flip();
+
+					return SelfForChaining(L);
+				}
+			}, {
+				"bor", [](lua_State * L)
+				{
+					return detail_bits::Combine(L, detail_bits::Or, false);
+				}
+			}, {
+				"borInPlace", [](lua_State * L)
+				{
+					return detail_bits::Combine(L, detail_bits::Or, true);
+				}
+			}, {
+				"bxor", [](lua_State * L)
+				{
+					return detail_bits::Combine(L, detail_bits::Xor, false);
+				}
+			}, {
+				"bxorInPlace", [](lua_State * L)
+				{
+					return detail_bits::Combine(L, detail_bits::Xor, true);
+				}
+			}, {
+				"__call", [](lua_State * L)
+				{
+					const BitMatrix & bits = *GetInstance<BitMatrix>(L, 1);
+					auto pos = detail_bits::Position(L, bits, lua_gettop(L) == 2);
+
+					return LuaXS::PushArgAndReturn(L, bits(pos.first, pos.second));
+				}
+			}, {
+				"coeffAssign", [](lua_State * L)
+				{
+					BitMatrix & bits = *GetInstance<BitMatrix>(L, 1);
+					bool bVector = lua_gettop(L) == 3;
+					auto pos = detail_bits::Position(L, bits, bVector);
+
+					bits.setCoeff(pos.first, pos.second, AsScalar<BoolMatrix>(L, bVector ? 3 : 4));
+
+					return 0;
+				}
+			}, {
+				"cols", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, GetInstance<BitMatrix>(L, 1)->cols());
+				}
+			}, {
+				"count", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, GetInstance<BitMatrix>(L, 1)->count());
+				}
+			}, {
+				"__eq", [](lua_State * L)
+				{
+					BitMatrix temp1, temp2;
+
+					return LuaXS::PushArgAndReturn(L, detail_bits::Operand(L, 1, temp1) == detail_bits::Operand(L, 2, temp2));
+				}
+			}, {
+				"__len", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, GetInstance<BitMatrix>(L, 1)->size());
+				}
+			}, {
+				"rows", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, GetInstance<BitMatrix>(L, 1)->rows());
+				}
+			}, {
+				"select", [](lua_State * L)
+				{
+					bool bThen, bElse;
+					auto & funcs = GetTypeData::GetSelectFuncs(L, bThen, bElse);
+
+					return funcs.mWithBits(L, *GetInstance<BitMatrix>(L, 1), bThen, bElse);	// bits, then, else, selection
+				}
+			}, {
+				"setConstant", [](lua_State * L)
+				{
+					GetInstance<BitMatrix>(L, 1)->setConstant(AsScalar<BoolMatrix>(L, 2));
+
+					return SelfForChaining(L);
+				}
+			}, {
+				"setOnes", [](lua_State * L)
+				{
+					GetInstance<BitMatrix>(L, 1)->setConstant(true);
+
+					return SelfForChaining(L);
+				}
+			}, {
+				"setZero", [](lua_State * L)
+				{
+					GetInstance<BitMatrix>(L, 1)->setConstant(false);
+
+					return SelfForChaining(L);
+				}
+			}, {
+				"size", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, GetInstance<BitMatrix>(L, 1)->size());
+				}
+			}, {
+				"__tostring", [](lua_State * L)
+				{
+					return Print(L, GetInstance<BitMatrix>(L, 1)->unpacked());
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "solver_base.h"
+#include "permutation.h"
 
 // Common Cholesky methods body.
 template<typename U, typename R> struct CholeskyMethodsBase : SolverMethodsBase<U, R> {
@@ -85,6 +86,13 @@ template<typename U, typename R, int UpLo> struct AttachMethods<Eigen::LDLT<U, U
 			}, {
 				"transpositionsP", [](lua_State * L)
 				{
+					if (WantsBool(L, "Native", 2))
+					{
+						New<TranspositionsOf<R>>(L, Getters::GetT(L)->transpositionsP());	// ldlt, how, tr
+
+						return 1;
+					}
+
 					auto td = TypeData<Eigen::MatrixXi>::Get(L);
 
 					luaL_argcheck(L, td, 2, "transpositionsP() requires int matrices");
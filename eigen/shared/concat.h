@@ -0,0 +1,132 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+
+//
+namespace detail_concat {
+	enum Layout { eHorizontal, eVertical, eBlockDiagonal };
+
+	// Bind each piece, given either as the arguments or as an array in the first one. Matrices,
+	// maps and blocks are referenced in place; other objects are converted.
+	template<typename M> void GetPieces (lua_State * L, std::vector<MatrixRef<M>> & pieces)
+	{
+		if (lua_istable(L, 1))
+		{
+			int n = int(lua_objlen(L, 1));
+
+			lua_settop(L, 1);	// pieces
+			luaL_checkstack(L, n, "Too many pieces");
+
+			for (int i = 1; i <= n; ++i) lua_rawgeti(L, 1, i);	// pieces, piece1, piece2, ...
+
+			lua_remove(L, 1);	// piece1, piece2, ...
+		}
+
+		int n = lua_gettop(L);
+
+		luaL_argcheck(L, n > 0, 1, "No pieces supplied");
+
+		pieces.reserve(size_t(n));	// N.B. guard references into temporaries against reallocation
+
+		for (int i = 1; i <= n; ++i)
+		{
+			pieces.emplace_back();
+			pieces.back().Init(L, i);
+		}
+	}
+
+	// Arrange the pieces in a new matrix, allocated once at its final size.
+	template<typename M, Layout layout> static int Concatenate (lua_State * L)
+	{
+		std::vector<MatrixRef<M>> pieces;
+
+		GetPieces(L, pieces);
+
+		Eigen::Index rows = 0, cols = 0;
+
+		for (size_t i = 0; i < pieces.size(); ++i)
+		{
+			const auto & piece = *pieces[i];
+
+			if (layout == eHorizontal)
+			{
+				luaL_argcheck(L, i == 0 || piece.rows() == rows, int(i + 1), "Pieces must have the same number of rows");
+
+				rows = piece.rows();
+			}
+
+			else rows += piece.rows();
+
+			if (layout == eVertical)
+			{
+				luaL_argcheck(L, i == 0 || piece.cols() == cols, int(i + 1), "Pieces must have the same number of columns");
+
+				cols = piece.cols();
+			}
+
+			else cols += piece.cols();
+		}
+
+		M out(rows, cols);
+		Eigen::Index row = 0, col = 0;
+
+		if (layout == eBlockDiagonal) out.setZero();
+
+		for (auto & ref : pieces)
+		{
+			const auto & piece = *ref;
+
+			out.block(row, col, piece.rows(), piece.cols()) = piece;
+
+			if (layout != eHorizontal) row += piece.rows();
+			if (layout != eVertical) col += piece.cols();
+		}
+
+		return NewRet<M>(L, std::move(out));
+	}
+}
+
+// Add concatenation functions, taking either several matrices or an array of them.
+template<typename M> struct AddConcatenation {
+	AddConcatenation (lua_State * L)
+	{
+		luaL_Reg funcs[] = {
+			{
+				"BlockDiag", detail_concat::Concatenate<M, detail_concat::eBlockDiagonal>
+			}, {
+				"HStack", detail_concat::Concatenate<M, detail_concat::eHorizontal>
+			}, {
+				"VStack", detail_concat::Concatenate<M, detail_concat::eVertical>
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, funcs);
+	}
+};
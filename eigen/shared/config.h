@@ -57,6 +57,30 @@
 
 	#define WANT_CDOUBLE
 	#define WANT_MAP
+#elif defined(EIGEN_INT64_ONLY)
+	#define PLUGIN_SUFFIX eigenint64
+	#define PLUGIN_NAME luaopen_plugin_eigenint64
+
+	#define WANT_INT64
+	#define WANT_MAP
+#elif defined(EIGEN_INT16_ONLY)
+	#define PLUGIN_SUFFIX eigenint16
+	#define PLUGIN_NAME luaopen_plugin_eigenint16
+
+	#define WANT_INT16
+	#define WANT_MAP
+#elif defined(EIGEN_UINT8_ONLY)
+	#define PLUGIN_SUFFIX eigenuint8
+	#define PLUGIN_NAME luaopen_plugin_eigenuint8
+
+	#define WANT_UINT8
+	#define WANT_MAP
+#elif defined(EIGEN_HALF_ONLY)
+	#define PLUGIN_SUFFIX eigenhalf
+	#define PLUGIN_NAME luaopen_plugin_eigenhalf
+
+	#define WANT_HALF
+	#define WANT_MAP
 #else
 	#define PLUGIN_SUFFIX eigen
 	#define PLUGIN_NAME luaopen_plugin_eigen
@@ -67,4 +91,8 @@
 	#define WANT_DOUBLE
 	#define WANT_CFLOAT
 	#define WANT_CDOUBLE
+	#define WANT_INT64
+	#define WANT_INT16
+	#define WANT_UINT8
+	#define WANT_HALF
 #endif
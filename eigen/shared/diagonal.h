@@ -0,0 +1,271 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+#include "macros.h"
+
+// Diagonal matrix, stored as its diagonal. It belongs to the family of its scalar type.
+template<typename R> struct DiagonalOf {
+	using Scalar = typename R::Scalar;
+	using Type = Eigen::DiagonalMatrix<Scalar, Eigen::Dynamic>;
+
+	Type mObject;
+
+	// Build from a vector of either orientation.
+	template<typename V> explicit DiagonalOf (const V & diagonal) : mObject(diagonal.size())
+	{
+		if (diagonal.cols() == 1) mObject.diagonal() = diagonal.col(0);
+		else mObject.diagonal() = diagonal.row(0).transpose();
+	}
+};
+
+template<typename R> struct HeapBytes<DiagonalOf<R>> {
+	static size_t Get (const DiagonalOf<R> & d) { return size_t(d.mObject.diagonal().size()) * sizeof(typename R::Scalar); }
+};
+
+//
+namespace detail_diag {
+	// Products involving at least one diagonal matrix, dispatched to Eigen's O(n^2) diagonal
+	// kernels (O(n) with another diagonal matrix or a scalar). The other operand may be a matrix,
+	// map, or block, referenced in place, or else anything convertible to one.
+	template<typename R> static int Product (lua_State * L)
+	{
+		using D = DiagonalOf<R>;
+
+		bool b1 = HasType<D>(L, 1), b2 = HasType<D>(L, 2);
+
+		if (b1 && b2)
+		{
+			const auto & d1 = LuaXS::UD<D>(L, 1)->mObject, & d2 = LuaXS::UD<D>(L, 2)->mObject;
+
+			luaL_argcheck(L, d1.rows() == d2.rows(), 2, "Diagonal sizes do not match");
+
+			New<D>(L, d1.diagonal().cwiseProduct(d2.diagonal()));	// d1, d2, d1d2
+
+			return 1;
+		}
+
+		int darg = b1 ? 1 : 2, other = b1 ? 2 : 1;
+		const auto & d = LuaXS::UD<D>(L, darg)->mObject;
+
+		if (!GetTypeData::FromObject(L, other))
+		{
+			New<D>(L, d.diagonal() * AsScalar<R>(L, other));	// d, s or s, d; ds
+
+			return 1;
+		}
+
+		MatrixRef<R> m{L, other};
+
+		if (b1)
+		{
+			luaL_argcheck(L, d.cols() == m->rows(), 2, "Matrix row count does not match diagonal size");
+
+			return NewRet<R>(L, d * *m);	// d, m, dm
+		}
+
+		else
+		{
+			luaL_argcheck(L, m->cols() == d.rows(), 1, "Matrix column count does not match diagonal size");
+
+			return NewRet<R>(L, *m * d);// m, d, md
+		}
+	}
+
+	// Does either operand of a product belong to the diagonal type?
+	template<typename R> bool HasDiagonal (lua_State * L)
+	{
+		return HasType<DiagonalOf<R>>(L, 1) || HasType<DiagonalOf<R>>(L, 2);
+	}
+
+	// Common body of in-place scaling: d, m. The matrix is scaled within its own storage.
+	template<typename R, bool bRows> static int Scale (lua_State * L)
+	{
+		const auto & d = GetInstance<DiagonalOf<R>>(L, 1)->mObject;
+		WritableMatrixRef<R> m{L, 2};
+
+		luaL_argcheck(L, (bRows ? m->rows() : m->cols()) == d.rows(), 2, "Matrix dimension does not match diagonal size");
+
+		if (bRows) *m = d * *m;
+		else *m = *m * d;
+
+		lua_settop(L, 2);	// d, m
+
+		return 1;
+	}
+
+	// Body of asDiagonal(): a dense matrix, or the native form on request.
+	template<typename T, typename R, bool = !std::is_same<R, BoolMatrix>::value> struct AsDiagonal {
+		using Getters = InstanceGetters<T, R>;
+
+		static int Do (lua_State * L)
+		{
+			if (WantsBool(L, "Native", 2))
+			{
+				MatrixRef<R> v{L, 1};
+
+				CheckVector(L, *v, 1);
+
+				New<DiagonalOf<R>>(L, *v);	// v, how, d
+
+				return 1;
+			}
+
+			EIGEN_MATRIX_GET_MATRIX(asDiagonal);
+		}
+	};
+
+	template<typename T, typename R> struct AsDiagonal<T, R, false> {
+		using Getters = InstanceGetters<T, R>;
+
+		static int Do (lua_State * L)
+		{
+			EIGEN_MATRIX_GET_MATRIX(asDiagonal);
+		}
+	};
+}
+
+/*******************
+* Diagonal methods *
+*******************/
+template<typename U, typename R> struct AttachMethods<DiagonalOf<U>, R> {
+	using Getters = InstanceGetters<DiagonalOf<U>, R>;
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"__mul", detail_diag::Product<R>
+			}, {
+				"apply", [](lua_State * L)
+				{
+					lua_settop(L, 2);	// d, m
+
+					return detail_diag::Product<R>(L);	// d, m, dm
+				}
+			}, {
+				"applyOnTheRight", [](lua_State * L)
+				{
+					lua_settop(L, 2);	// d, m
+					lua_insert(L, 1);	// m, d
+
+					return detail_diag::Product<R>(L);	// m, d, md
+				}
+			}, {
+				"determinant", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, Getters::GetT(L)->mObject.diagonal().prod());
+				}
+			}, {
+				"diagonal", [](lua_State * L)
+				{
+					return NewRet<R>(L, Getters::GetT(L)->mObject.diagonal());
+				}
+			}, {
+				"inverse", [](lua_State * L)
+				{
+					New<DiagonalOf<U>>(L, Getters::GetT(L)->mObject.diagonal().cwiseInverse());	// d, inv
+
+					return 1;
+				}
+			}, {
+				"scaleCols", detail_diag::Scale<R, false>
+			}, {
+				"scaleRows", detail_diag::Scale<R, true>
+			}, {
+				"size", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, Getters::GetT(L)->mObject.rows());
+				}
+			}, {
+				"solve", [](lua_State * L)
+				{
+					const auto & d = Getters::GetT(L)->mObject;
+					MatrixRef<R> b{L, 2};
+
+					luaL_argcheck(L, b->rows() == d.rows(), 2, "Right-hand side row count does not match diagonal size");
+
+					return NewRet<R>(L, d.inverse() * *b);	// d, b, x
+				}
+			}, {
+				"toDenseMatrix", [](lua_State * L)
+				{
+					return NewRet<R>(L, Getters::GetT(L)->mObject.toDenseMatrix());
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+template<typename R> struct AuxTypeName<DiagonalOf<R>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "DiagonalMatrix<");
+
+		AuxTypeName<R>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
+
+// Add a diagonal matrix factory for non-boolean types. It takes the diagonal as a vector, or a
+// size for the identity.
+template<typename M> struct AddDiagonal {
+	AddDiagonal (lua_State * L)
+	{
+		luaL_Reg funcs[] = {
+			{
+				"Diagonal", [](lua_State * L)
+				{
+					if (lua_type(L, 1) == LUA_TNUMBER) New<DiagonalOf<M>>(L, ColVector<typename M::Scalar>::Ones(LuaXS::Int(L, 1)));	// n, d
+
+					else
+					{
+						MatrixRef<M> v{L, 1};
+
+						CheckVector(L, *v, 1);
+
+						New<DiagonalOf<M>>(L, *v);	// v, d
+					}
+
+					return 1;
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, funcs);
+	}
+};
+
+template<> struct AddDiagonal<BoolMatrix> {
+	AddDiagonal (lua_State *) {}
+};
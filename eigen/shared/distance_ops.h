@@ -0,0 +1,222 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "types.h"
+#include "utils.h"
+#include "macros.h"
+
+namespace detail_distance {
+	// Squared distances between rows of two matrices, via ||a||^2 + ||b||^2 - 2 * A * B^T. The
+	// work is tiled, so that the product and norms are formed a block at a time.
+	template<typename R> struct PairwiseDistances {
+		using Scalar = typename R::Scalar;
+		using Vector = ColVector<Scalar>;
+
+		enum { kTileA = 256, kTileB = 1024 };	// Rows of A and B handled per tile
+
+		const typename MatrixRef<R>::Type & mA, & mB;	// Row sets
+		Vector mNormsA, mNormsB;// Squared norms of each row
+
+		PairwiseDistances (const typename MatrixRef<R>::Type & a, const typename MatrixRef<R>::Type & b) : mA(a), mB(b)
+		{
+			mNormsA = a.rowwise().squaredNorm();
+			mNormsB = b.rowwise().squaredNorm();
+		}
+
+		// Compute the distances between a range of rows from each set.
+		void Tile (R & out, Eigen::Index i, Eigen::Index na, Eigen::Index j, Eigen::Index nb) const
+		{
+			out.resize(na, nb);
+			out.noalias() = Scalar(-2) * mA.middleRows(i, na) * mB.middleRows(j, nb).transpose();
+			out.colwise() += mNormsA.segment(i, na);
+			out.rowwise() += mNormsB.segment(j, nb).transpose();
+			out = out.cwiseMax(Scalar(0)); // guard against cancellation
+		}
+
+		// Compute all distances, tile by tile.
+		template<typename Out> void All (Out & out) const
+		{
+			R tile;
+
+			for (Eigen::Index i = 0; i < mA.rows(); i += kTileA)
+			{
+				Eigen::Index na = (std::min)(Eigen::Index(kTileA), mA.rows() - i);
+
+				for (Eigen::Index j = 0; j < mB.rows(); j += kTileB)
+				{
+					Eigen::Index nb = (std::min)(Eigen::Index(kTileB), mB.rows() - j);
+
+					Tile(tile, i, na, j, nb);
+
+					out.block(i, j, na, nb) = tile;
+				}
+			}
+		}
+
+		// Find the k nearest rows of B to each row of A, without forming the full matrix. Each row
+		// keeps a max-heap of its best candidates, which is sorted into ascending order at the end.
+		void Nearest (Eigen::Index k, Eigen::MatrixXi & indices, R & dists) const
+		{
+			using Entry = std::pair<Scalar, int>;
+
+			std::vector<std::vector<Entry>> heaps(size_t(kTileA));
+			R tile;
+
+			indices.resize(mA.rows(), k);
+			dists.resize(mA.rows(), k);
+
+			for (Eigen::Index i = 0; i < mA.rows(); i += kTileA)
+			{
+				Eigen::Index na = (std::min)(Eigen::Index(kTileA), mA.rows() - i);
+
+				for (auto & heap : heaps) heap.clear();
+
+				for (Eigen::Index j = 0; j < mB.rows(); j += kTileB)
+				{
+					Eigen::Index nb = (std::min)(Eigen::Index(kTileB), mB.rows() - j);
+
+					Tile(tile, i, na, j, nb);
+
+					for (Eigen::Index r = 0; r < na; ++r)
+					{
+						auto & heap = heaps[size_t(r)];
+
+						for (Eigen::Index c = 0; c < nb; ++c)
+						{
+							Entry entry{tile(r, c), int(j + c)};
+
+							if (Eigen::Index(heap.size()) < k)
+							{
+								heap.push_back(entry);
+
+								std::push_heap(heap.begin(), heap.end());
+							}
+
+							else if (entry < heap.front())
+							{
+								std::pop_heap(heap.begin(), heap.end());
+
+								heap.back() = entry;
+
+								std::push_heap(heap.begin(), heap.end());
+							}
+						}
+					}
+				}
+
+				for (Eigen::Index r = 0; r < na; ++r)
+				{
+					auto & heap = heaps[size_t(r)];
+
+					std::sort_heap(heap.begin(), heap.end());
+
+					for (Eigen::Index c = 0; c < k; ++c)
+					{
+						dists(i + r, c) = heap[size_t(c)].first;
+						indices(i + r, c) = heap[size_t(c)].second + 1;
+					}
+				}
+			}
+		}
+	};
+
+	// Squared distances between all rows of A and B: a, b[, out]. Results are written to the
+	// output, if provided; otherwise to a new matrix.
+	template<typename R> static int PairwiseSquaredDistances (lua_State * L)
+	{
+		MatrixRef<R> a{L, 1}, b{L, 2};
+
+		luaL_argcheck(L, a->cols() == b->cols(), 2, "Rows must have the same length");
+
+		PairwiseDistances<R> pd{*a, *b};
+
+		if (lua_isuserdata(L, 3))
+		{
+			WritableMatrixRef<R> out{L, 3};
+
+			luaL_argcheck(L, out->rows() == a->rows() && out->cols() == b->rows(), 3, "Output must be #rows(a) x #rows(b)");
+
+			pd.All(*out);
+
+			lua_settop(L, 3);	// a, b, out
+		}
+
+		else
+		{
+			R & out = *New<R>(L, a->rows(), b->rows());	// a, b, out
+
+			pd.All(out);
+		}
+
+		return 1;
+	}
+
+	// Indices and squared distances of the k nearest rows of B to each row of A: a, b, k.
+	template<typename R> static int KNearest (lua_State * L)
+	{
+		MatrixRef<R> a{L, 1}, b{L, 2};
+		Eigen::Index k = LuaXS::Int(L, 3);
+
+		luaL_argcheck(L, a->cols() == b->cols(), 2, "Rows must have the same length");
+		luaL_argcheck(L, k > 0 && k <= b->rows(), 3, "k must be between 1 and #rows(b)");
+
+		auto td = TypeData<Eigen::MatrixXi>::Get(L, GetTypeData::eFetchIfMissing);
+
+		luaL_argcheck(L, td, 1, "kNearest() requires int matrices");
+
+		Eigen::MatrixXi indices;
+		R dists;
+
+		PairwiseDistances<R>{*a, *b}.Nearest(k, indices, dists);
+
+		PUSH_TYPED_DATA_NO_RET(indices);// a, b, k, indices
+
+		New<R>(L, std::move(dists));// a, b, k, indices, dists
+
+		return 2;
+	}
+}
+
+// Methods assigned when the underlying type is real floating point.
+template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsInteger && !Eigen::NumTraits<typename T::Scalar>::IsComplex> struct DistanceOps {
+	DistanceOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"kNearest", detail_distance::KNearest<R>
+			}, {
+				"pairwiseSquaredDistances", detail_distance::PairwiseSquaredDistances<R>
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// No-op for integer and complex types.
+template<typename T, typename R> struct DistanceOps<T, R, false> {
+	DistanceOps (lua_State *) {}
+};
@@ -0,0 +1,170 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+
+//
+namespace detail_gather {
+	// Read 1-based indices, from an int matrix or an array, and convert them to 0-based ones.
+	inline void GetIndices (lua_State * L, int arg, Eigen::Index limit, std::vector<Eigen::Index> & indices)
+	{
+		if (lua_istable(L, arg))
+		{
+			for (size_t i = 1, n = lua_objlen(L, arg); i <= n; ++i, lua_pop(L, 1))
+			{
+				lua_rawgeti(L, arg, int(i));// ..., index
+
+				indices.push_back(Eigen::Index(LuaXS::Int(L, -1)));
+			}
+		}
+
+		else
+		{
+			MatrixRef<Eigen::MatrixXi> im{L, arg};
+
+			CheckVector(L, *im, arg);
+
+			for (Eigen::Index i = 0; i < im->size(); ++i) indices.push_back(Eigen::Index(im->cols() == 1 ? im->coeff(i, 0) : im->coeff(0, i)));
+		}
+
+		for (auto & index : indices)
+		{
+			luaL_argcheck(L, index >= 1 && index <= limit, arg, "Index out of range");
+
+			--index;
+		}
+	}
+
+	// Call a function on each run of consecutive indices, with its position in the list, its
+	// first index, and its length.
+	template<typename F> void ForEachRun (const std::vector<Eigen::Index> & indices, F && func)
+	{
+		for (size_t i = 0, n = indices.size(); i < n; )
+		{
+			size_t j = i + 1;
+
+			while (j < n && indices[j] == indices[j - 1] + 1) ++j;
+
+			func(Eigen::Index(i), indices[i], Eigen::Index(j - i));
+
+			i = j;
+		}
+	}
+
+	// Common form of gather methods: idx[, out]. Runs are copied as whole blocks.
+	template<typename R, bool bRows> static int Gather (lua_State * L)
+	{
+		MatrixRef<R> m{L, 1};
+		std::vector<Eigen::Index> indices;
+
+		GetIndices(L, 2, bRows ? m->rows() : m->cols(), indices);
+
+		Eigen::Index n = Eigen::Index(indices.size()), rows = bRows ? n : m->rows(), cols = bRows ? m->cols() : n;
+		WritableMatrixRef<R> out;
+
+		if (lua_isuserdata(L, 3))
+		{
+			out.Init(L, 3);
+
+			luaL_argcheck(L, out->rows() == rows && out->cols() == cols, 3, "Output has wrong dimensions");
+			luaL_argcheck(L, out->data() != m->data(), 3, "Output may not be the source matrix");
+
+			lua_settop(L, 3);	// m, idx, out
+		}
+
+		else
+		{
+			New<R>(L, rows, cols);	// m, idx[, nil], out
+
+			out.Init(L, lua_gettop(L));
+		}
+
+		ForEachRun(indices, [&m, &out](Eigen::Index pos, Eigen::Index index, Eigen::Index len) {
+			if (bRows) out->middleRows(pos, len) = m->middleRows(index, len);
+			else out->middleCols(pos, len) = m->middleCols(index, len);
+		});
+
+		return 1;
+	}
+
+	// Common form of scatter methods: idx, src. Row or column k of the source goes to the one
+	// named by the k-th index. When adding, repeated indices accumulate.
+	template<typename R, bool bRows, bool bAdd> static int Scatter (lua_State * L)
+	{
+		WritableMatrixRef<R> m{L, 1};
+		std::vector<Eigen::Index> indices;
+
+		GetIndices(L, 2, bRows ? m->rows() : m->cols(), indices);
+
+		MatrixRef<R> src{L, 3};
+		Eigen::Index n = Eigen::Index(indices.size());
+
+		luaL_argcheck(L, bRows ? src->rows() == n && src->cols() == m->cols() : src->cols() == n && src->rows() == m->rows(), 3, "Source has wrong dimensions");
+
+		ForEachRun(indices, [&m, &src](Eigen::Index pos, Eigen::Index index, Eigen::Index len) {
+			if (bRows)
+			{
+				if (bAdd) m->middleRows(index, len) += src->middleRows(pos, len);
+				else m->middleRows(index, len) = src->middleRows(pos, len);
+			}
+
+			else
+			{
+				if (bAdd) m->middleCols(index, len) += src->middleCols(pos, len);
+				else m->middleCols(index, len) = src->middleCols(pos, len);
+			}
+		});
+
+		return SelfForChaining(L);
+	}
+}
+
+// Gather and scatter methods, taking index vectors in the form of int matrices or arrays.
+template<typename T, typename R> struct GatherOps {
+	GatherOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"gatherCols", detail_gather::Gather<R, false>
+			}, {
+				"gatherRows", detail_gather::Gather<R, true>
+			}, {
+				"scatterAddCols", detail_gather::Scatter<R, false, true>
+			}, {
+				"scatterAddRows", detail_gather::Scatter<R, true, true>
+			}, {
+				"scatterCols", detail_gather::Scatter<R, false, false>
+			}, {
+				"scatterRows", detail_gather::Scatter<R, true, false>
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
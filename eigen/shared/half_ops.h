@@ -0,0 +1,150 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "types.h"
+#include "utils.h"
+#include "macros.h"
+
+namespace detail_half {
+	// Fetch a vector's coefficient, whatever its orientation, widened for accumulation.
+	template<typename V> float At (const V & v, Eigen::Index i)
+	{
+		return static_cast<float>(v.cols() == 1 ? v.coeff(i, 0) : v.coeff(0, i));
+	}
+
+	// Multiply a matrix by a vector, one column at a time so that the matrix is streamed once.
+	template<typename T, typename V> Eigen::VectorXf Gemv (const T & m, const V & x)
+	{
+		Eigen::VectorXf y = Eigen::VectorXf::Zero(m.rows());
+
+		for (Eigen::Index j = 0; j < m.cols(); ++j)
+		{
+			float xj = At(x, j);
+
+			if (xj != 0.0f) y += m.col(j).template cast<float>() * xj;
+		}
+
+		return y;
+	}
+
+	// Push a float result, which will typically belong to another module.
+	inline int PushFloats (lua_State * L, Eigen::MatrixXf & m)
+	{
+		auto td = TypeData<Eigen::MatrixXf>::Get(L, GetTypeData::eFetchIfMissing);
+
+		luaL_argcheck(L, td, 1, "Float matrix type unavailable for result");
+
+		PUSH_TYPED_DATA(m);
+	}
+}
+
+// Methods for half-precision storage. Coefficients are widened to float as they are read, so
+// every sum is accumulated in float.
+template<typename T> struct HalfOps {
+	using Getters = InstanceGetters<T, HalfMatrix>;
+
+	HalfOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"dot", [](lua_State * L)
+				{
+					const T & m = *Getters::GetT(L);
+					MatrixRef<HalfMatrix> other{L, 2};
+
+					CheckVector(L, m, 1);
+					CheckVector(L, *other, 2);
+
+					luaL_argcheck(L, m.size() == other->size(), 2, "Mismatched vector sizes");
+
+					float sum = 0.0f;
+
+					for (Eigen::Index i = 0; i < m.size(); ++i) sum += detail_half::At(m, i) * detail_half::At(*other, i);
+
+					return LuaXS::PushArgAndReturn(L, sum);
+				}
+			}, {
+				"gemv", [](lua_State * L)
+				{
+					const T & m = *Getters::GetT(L);
+					GetTypeData * td = GetTypeData::FromObject(L, 2);
+					Eigen::MatrixXf y;
+
+					// Half vectors are read directly, anything else as floats.
+					if (td && td->GetInfo().mType == eHalf)
+					{
+						MatrixRef<HalfMatrix> x{L, 2};
+
+						CheckVector(L, *x, 2);
+
+						luaL_argcheck(L, x->size() == m.cols(), 2, "Vector size does not match column count");
+
+						y = detail_half::Gemv(m, *x);
+					}
+
+					else
+					{
+						TypeData<Eigen::MatrixXf>::Get(L, GetTypeData::eFetchIfMissing);
+
+						MatrixRef<Eigen::MatrixXf> x{L, 2};
+
+						CheckVector(L, *x, 2);
+
+						luaL_argcheck(L, x->size() == m.cols(), 2, "Vector size does not match column count");
+
+						y = detail_half::Gemv(m, *x);
+					}
+
+					return detail_half::PushFloats(L, y);	// m, x, y
+				}
+			}, {
+				"mean", [](lua_State * L)
+				{
+					const T & m = *Getters::GetT(L);
+
+					return LuaXS::PushArgAndReturn(L, m.size() ? m.template cast<float>().sum() / float(m.size()) : 0.0f);
+				}
+			}, {
+				"norm", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, std::sqrt(Getters::GetT(L)->template cast<float>().squaredNorm()));
+				}
+			}, {
+				"squaredNorm", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, Getters::GetT(L)->template cast<float>().squaredNorm());
+				}
+			}, {
+				"sum", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, Getters::GetT(L)->template cast<float>().sum());
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
@@ -27,6 +27,9 @@
 #include "types.h"
 #include "utils.h"
 #include "matrix.h"
+#include "concat.h"
+#include "diagonal.h"
+#include "permutation.h"
 
 // Add LinSpaced*() for non-boolean matrices.
 template<typename M> struct AddLinSpaced {
@@ -55,8 +58,8 @@ template<> struct AddLinSpaced<BoolMatrix> {
     AddLinSpaced (lua_State *) {}
 };
 
-// Add Umeyama() for real floating point matrices.
-template<typename M, bool = !Eigen::NumTraits<typename M::Scalar>::IsInteger && !Eigen::NumTraits<typename M::Scalar>::IsComplex> struct AddUmeyama {
+// Add Umeyama() for real floating point matrices, other than half-precision storage.
+template<typename M, bool = !Eigen::NumTraits<typename M::Scalar>::IsInteger && !Eigen::NumTraits<typename M::Scalar>::IsComplex && !std::is_same<M, HalfMatrix>::value> struct AddUmeyama {
 	AddUmeyama (lua_State * L)
 	{
 		luaL_Reg funcs[] = {
@@ -77,6 +80,60 @@ template<typename M> struct AddUmeyama<M, false> {
 	AddUmeyama (lua_State *) {}
 };
 
+// Add a streaming statistics factory for real floating point matrices. Accumulators track the
+// full covariance, unless "VarianceOnly" is requested.
+template<typename M, bool = !Eigen::NumTraits<typename M::Scalar>::IsInteger && !Eigen::NumTraits<typename M::Scalar>::IsComplex && !std::is_same<M, HalfMatrix>::value> struct AddStatistics {
+	AddStatistics (lua_State * L)
+	{
+		luaL_Reg funcs[] = {
+			{
+				"StatisticsAccumulator", [](lua_State * L)
+				{
+					int n = LuaXS::Int(L, 1);
+
+					luaL_argcheck(L, n >= 1, 1, "Accumulator needs at least one variable");
+
+					New<StatisticsAccumulator<M>>(L, n, !WantsBool(L, "VarianceOnly", 2));	// n[, how], acc
+
+					return 1;
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, funcs);
+	}
+};
+
+template<typename M> struct AddStatistics<M, false> {
+	AddStatistics (lua_State *) {}
+};
+
+// Add a nonlinear least-squares factory for real floating point matrices. The Jacobian is
+// supplied by the objective, unless "FiniteDifference" is requested.
+template<typename M, bool = !Eigen::NumTraits<typename M::Scalar>::IsInteger && !Eigen::NumTraits<typename M::Scalar>::IsComplex && !std::is_same<M, HalfMatrix>::value> struct AddLevenbergMarquardt {
+	AddLevenbergMarquardt (lua_State * L)
+	{
+		luaL_Reg funcs[] = {
+			{
+				"LevenbergMarquardt", [](lua_State * L)
+				{
+					New<LevenbergMarquardt<M>>(L, LuaXS::Int(L, 1), WantsBool(L, "FiniteDifference", 2));	// m[, how], lm
+
+					return 1;
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, funcs);
+	}
+};
+
+template<typename M> struct AddLevenbergMarquardt<M, false> {
+	AddLevenbergMarquardt (lua_State *) {}
+};
+
 // Enable some type-related code generation (in this module) for appropriate matrix families.
 #if defined(EIGEN_CORE) || defined(EIGEN_PLUGIN_BASIC)
 	template<> struct IsMatrixFamilyImplemented<BoolMatrix> : std::true_type {};
@@ -102,6 +159,22 @@ template<typename M> struct AddUmeyama<M, false> {
 	template<> struct IsMatrixFamilyImplemented<Eigen::MatrixXcd> : std::true_type {};
 #endif
 
+#ifdef WANT_INT64
+	template<> struct IsMatrixFamilyImplemented<Int64Matrix> : std::true_type {};
+#endif
+
+#ifdef WANT_INT16
+	template<> struct IsMatrixFamilyImplemented<Int16Matrix> : std::true_type {};
+#endif
+
+#ifdef WANT_UINT8
+	template<> struct IsMatrixFamilyImplemented<Uint8Matrix> : std::true_type {};
+#endif
+
+#ifdef WANT_HALF
+	template<> struct IsMatrixFamilyImplemented<HalfMatrix> : std::true_type {};
+#endif
+
 // Supplies some front end functions for the type, in particular various matrix factories.
 template<typename M> static void AddType (lua_State * L)
 {
@@ -246,13 +319,20 @@ template<typename M> static void AddType (lua_State * L)
 		}, {
 			"RandomPermutation", [](lua_State * L)
 			{
-				Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> perm{LuaXS::Int(L, 1)};
+				Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> perm{LuaXS::Int(L, 1)};
 
 				perm.setIdentity();
 
 				std::random_shuffle(perm.indices().data(), perm.indices().data() + perm.indices().size());
 
-				return NewRet<M>(L, perm);// size, perm
+				if (WantsBool(L, "Native", 2))
+				{
+					New<PermutationOf<M>>(L, perm);	// size, how, perm
+
+					return 1;
+				}
+
+				return NewRet<M>(L, perm);// size[, how], perm
 			}
 		}, {
 			"RowVector", [](lua_State * L)
@@ -281,7 +361,12 @@ template<typename M> static void AddType (lua_State * L)
 
 	luaL_register(L, nullptr, funcs);
 
+	AddConcatenation<M> ac{L};
+	AddDiagonal<M> ad{L};
+	AddPermutations<M> ap{L};
 	AddUmeyama<M> au{L};
+	AddStatistics<M> as{L};
+	AddLevenbergMarquardt<M> alm{L};
 
 	#if defined(EIGEN_CORE) || defined(EIGEN_PLUGIN_BASIC)
 		TypeName<typename M::Scalar>(L);// eigen, funcs, name
@@ -329,6 +414,80 @@ CORONA_EXPORT int PLUGIN_NAME (lua_State * L)
 		lua_rawset(L, LUA_REGISTRYINDEX);	// ..., M; registry = { ..., NewType, [cachestack] = true }
 
 		AddType<BoolMatrix>(L);
+
+		// Register packed masks up front, so that other modules can produce them.
+		TypeData<BitMatrix>::Get(L, GetTypeData::eCreateIfMissing);
+
+		// Add queries and policy for the heap memory held outside of Lua's view.
+		luaL_Reg heap_funcs[] = {
+			{
+				// Returns the bytes held by live instances, those bytes broken down by type, and the
+				// bytes held back in cached instances' buffers for recycling.
+				"HeapUsage", [](lua_State * L)
+				{
+					HeapUsage * usage = HeapUsage::Get(L);
+
+					lua_pushnumber(L, lua_Number(usage ? usage->mLiveBytes : 0U));	// total
+					lua_newtable(L);// total, by_type
+					lua_getfield(L, LUA_REGISTRYINDEX, EIGEN_META_TO_TYPE_DATA_KEY);// total, by_type, meta_to_type_data
+
+					for (lua_pushnil(L); lua_next(L, 3); lua_pop(L, 1))
+					{
+						auto td = LuaXS::UD<GetTypeData>(L, -1);// total, by_type, meta_to_type_data, key, td
+
+						if (!td->mLiveCount && !td->mLiveBytes) continue;
+
+						lua_createtable(L, 0, 2);	// total, by_type, meta_to_type_data, key, td, entry
+						lua_pushnumber(L, lua_Number(td->mLiveBytes));	// total, by_type, meta_to_type_data, key, td, entry, bytes
+						lua_setfield(L, -2, "bytes");	// total, by_type, meta_to_type_data, key, td, entry = { bytes = bytes }
+						lua_pushnumber(L, lua_Number(td->mLiveCount));	// total, by_type, meta_to_type_data, key, td, entry, count
+						lua_setfield(L, -2, "count");	// total, by_type, meta_to_type_data, key, td, entry = { bytes, count = count }
+						lua_setfield(L, 2, td->GetName());	// total, by_type = { ..., [name] = entry }, meta_to_type_data, key, td
+					}
+
+					lua_pop(L, 1);	// total, by_type
+					lua_pushnumber(L, lua_Number(usage ? usage->mRecycledBytes : 0U));	// total, by_type, recycled
+
+					return 3;
+				}
+			}, {
+				"SetBufferRecycling", [](lua_State * L)
+				{
+					HeapUsage * usage = HeapUsage::Get(L);
+
+					if (usage) usage->mRecycleBuffers = lua_toboolean(L, 1) != 0;
+
+					return 0;
+				}
+			}, {
+				"SetGcPressure", [](lua_State * L)
+				{
+					lua_Number threshold = luaL_checknumber(L, 1), scale = luaL_optnumber(L, 2, 1);
+					HeapUsage * usage = HeapUsage::Get(L);
+
+					if (usage)
+					{
+						usage->mThreshold = size_t((std::max)(threshold, lua_Number(0)));
+						usage->mStepScale = scale;
+						usage->mPending = 0;
+					}
+
+					return 0;
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, heap_funcs);
+
+		// Report which instruction set the dispatched kernels use.
+		lua_pushstring(L, detail_simd::LevelName(detail_simd::GetLevel()));	// ..., M, level
+		lua_pushcclosure(L, [](lua_State * L) {
+			lua_pushvalue(L, lua_upvalueindex(1));	// level
+
+			return 1;
+		}, 1);	// ..., M, SimdLevel
+		lua_setfield(L, -2, "SimdLevel");	// ..., M = { ..., SimdLevel = SimdLevel }
 	#endif
 	
 	#ifdef WANT_INT
@@ -351,5 +510,21 @@ CORONA_EXPORT int PLUGIN_NAME (lua_State * L)
 		AddType<Eigen::MatrixXcd>(L);
 	#endif
 
+	#ifdef WANT_INT64
+		AddType<Int64Matrix>(L);
+	#endif
+
+	#ifdef WANT_INT16
+		AddType<Int16Matrix>(L);
+	#endif
+
+	#ifdef WANT_UINT8
+		AddType<Uint8Matrix>(L);
+	#endif
+
+	#ifdef WANT_HALF
+		AddType<HalfMatrix>(L);
+	#endif
+
 	return 1;
 }
@@ -0,0 +1,285 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "solver_base.h"
+
+// Resumable iterative solver for A * x = b, for spreading a large solve across several calls,
+// e.g. one per frame. All state lives in the object, and each step() runs until a budget of
+// iterations and / or elapsed time is spent. Conjugate gradient suits self-adjoint positive
+// definite matrices, BiCGSTAB the general case; both use a diagonal (Jacobi) preconditioner.
+template<typename R> struct IterativeSolver {
+	using Scalar = typename R::Scalar;
+	using Real = typename Eigen::NumTraits<Scalar>::Real;
+	using Vector = ColVector<Scalar>;
+
+	enum Method { eConjugateGradient, eBiCGSTAB };
+
+	R mMatrix;	// Coefficient matrix
+	Vector mInvDiagonal;// Preconditioner, i.e. the reciprocal of the diagonal, where nonzero
+	Vector mB, mX, mR, mR0, mP, mV;	// Right-hand side, iterate, residual, and search state
+	Scalar mRho{1}, mAlpha{1}, mOmega{1};	// Recurrence scalars
+	Real mBNorm{0}, mError{0};	// Norm of b; relative residual of the current iterate
+	Real mTolerance{Eigen::NumTraits<Real>::epsilon()};	// Relative residual at which to stop
+	Method mMethod;	// Which iteration is in use?
+	Eigen::ComputationInfo mInfo{Eigen::Success};	// Outcome, once done
+	int mMaxIterations;	// Iteration limit
+	int mIterations{0};	// Iterations taken since the last start()
+	bool mDone{true};	// Is the current solve finished?
+
+	IterativeSolver (const R & m, Method method) : mMatrix{m}, mMethod{method}, mMaxIterations{int(2 * m.cols())}
+	{
+		mInvDiagonal = m.diagonal();
+
+		for (Eigen::Index i = 0; i < mInvDiagonal.size(); ++i) mInvDiagonal[i] = mInvDiagonal[i] != Scalar(0) ? Scalar(1) / mInvDiagonal[i] : Scalar(1);
+	}
+
+	Vector Precondition (const Vector & v) const
+	{
+		return mInvDiagonal.cwiseProduct(v);
+	}
+
+	// Finish if the residual is small enough, or the iterations are spent.
+	bool CheckDone (void)
+	{
+		mError = mR.norm() / mBNorm;
+
+		if (!(std::isfinite)(mError)) mInfo = Eigen::NumericalIssue;
+		else if (mError <= mTolerance) mInfo = Eigen::Success;
+		else if (mIterations >= mMaxIterations) mInfo = Eigen::NoConvergence;
+		else return false;
+
+		mDone = true;
+
+		return true;
+	}
+
+	// Begin a new solve from the initial guess x0.
+	template<typename B, typename X> void Start (const B & b, const X & x0)
+	{
+		mB = b;
+		mX = x0;
+		mR = mB - mMatrix * mX;
+		mBNorm = mB.norm();
+		mIterations = 0;
+		mDone = false;
+
+		if (mBNorm == Real(0))
+		{
+			mX.setZero();
+
+			mError = 0;
+			mInfo = Eigen::Success;
+			mDone = true;
+		}
+
+		else if (mMethod == eConjugateGradient)
+		{
+			mP = Precondition(mR);
+			mRho = mR.dot(mP);
+		}
+
+		else
+		{
+			mR0 = mR;
+			mP.setZero(mR.size());
+			mV.setZero(mR.size());
+
+			mRho = mAlpha = mOmega = Scalar(1);
+		}
+
+		if (!mDone) CheckDone();
+	}
+
+	void StepCG (void)
+	{
+		Vector q = mMatrix * mP;
+
+		mAlpha = mRho / mP.dot(q);
+
+		mX += mAlpha * mP;
+		mR -= mAlpha * q;
+
+		Vector z = Precondition(mR);
+		Scalar rho_old = mRho;
+
+		mRho = mR.dot(z);
+		mP = z + (mRho / rho_old) * mP;
+	}
+
+	void StepBiCGSTAB (void)
+	{
+		Scalar rho_old = mRho;
+
+		mRho = mR0.dot(mR);
+
+		// Restart if r0 has become (nearly) orthogonal to the residual.
+		if (std::abs(mRho) < Eigen::NumTraits<Real>::epsilon() * mR0.squaredNorm())
+		{
+			mR = mB - mMatrix * mX;
+			mR0 = mR;
+			mRho = mR.squaredNorm();
+
+			mP.setZero();
+			mV.setZero();
+
+			rho_old = mAlpha = mOmega = Scalar(1);
+		}
+
+		mP = mR + ((mRho / rho_old) * (mAlpha / mOmega)) * (mP - mOmega * mV);
+
+		Vector y = Precondition(mP);
+
+		mV.noalias() = mMatrix * y;
+		mAlpha = mRho / mR0.dot(mV);
+
+		Vector s = mR - mAlpha * mV, z = Precondition(s), t = mMatrix * z;
+		Real tt = t.squaredNorm();
+
+		mOmega = tt > Real(0) ? t.dot(s) / tt : Scalar(0);
+
+		mX += mAlpha * y + mOmega * z;
+		mR = s - mOmega * t;
+	}
+
+	// Iterate until done or out of budget; non-positive budgets are ignored. At least one iteration
+	// is taken per call, so that progress is always made.
+	bool step (int iterations, double microseconds)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; !mDone; )
+		{
+			if (mMethod == eConjugateGradient) StepCG();
+			else StepBiCGSTAB();
+
+			++mIterations;
+
+			if (CheckDone()) break;
+			if (iterations > 0 && ++i >= iterations) break;
+			if (microseconds > 0 && std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() >= microseconds) break;
+		}
+
+		return mDone;
+	}
+
+	Real error (void) const { return mError; }
+	Eigen::ComputationInfo info (void) const { return mInfo; }
+	bool isDone (void) const { return mDone; }
+	int iterations (void) const { return mIterations; }
+	int maxIterations (void) const { return mMaxIterations; }
+	Real tolerance (void) const { return mTolerance; }
+
+	void setMaxIterations (int count) { mMaxIterations = count; }
+	void setTolerance (Real tolerance) { mTolerance = tolerance; }
+};
+
+/**************************
+* IterativeSolver methods *
+**************************/
+template<typename U, typename R> struct AttachMethods<IterativeSolver<U>, R> : SolverMethodsBase<IterativeSolver<U>, R> {
+	using Getters = InstanceGetters<IterativeSolver<U>, R>;
+	using Real = typename IterativeSolver<U>::Real;
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(error)
+			}, {
+				"info", SolverMethodsBase<IterativeSolver<U>, R>::template Info<>
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(isDone)
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(iterations)
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(maxIterations)
+			}, {
+				"setMaxIterations", SolverMethodsBase<IterativeSolver<U>, R>::template SetMaxIterations<>
+			}, {
+				"setTolerance", [](lua_State * L)
+				{
+					Getters::GetT(L)->setTolerance(LuaXS::GetArg<Real>(L, 2));
+
+					return SelfForChaining(L);	// solver, tolerance, solver
+				}
+			}, {
+				"solution", [](lua_State * L)
+				{
+					return NewRet<R>(L, Getters::GetT(L)->mX);	// solver, x
+				}
+			}, {
+				// b[, x0]: begin solving against a right-hand side, from an initial guess or zero.
+				"start", [](lua_State * L)
+				{
+					IterativeSolver<U> & solver = *Getters::GetT(L);
+					MatrixRef<R> b{L, 2};
+
+					luaL_argcheck(L, b->cols() == 1 && b->rows() == solver.mMatrix.rows(), 2, "Right-hand side must be a column vector matching the row count");
+
+					if (!lua_isnoneornil(L, 3))
+					{
+						MatrixRef<R> x0{L, 3};
+
+						luaL_argcheck(L, x0->cols() == 1 && x0->rows() == solver.mMatrix.cols(), 3, "Initial guess must be a column vector matching the column count");
+
+						solver.Start(*b, *x0);
+					}
+
+					else solver.Start(*b, IterativeSolver<U>::Vector::Zero(solver.mMatrix.cols()));
+
+					return SelfForChaining(L);	// solver, b[, x0], solver
+				}
+			}, {
+				// [iterations[, microseconds]]: run for at most this many iterations and / or this long,
+				// returning whether the solve is done, and the iterations taken so far.
+				"step", [](lua_State * L)
+				{
+					IterativeSolver<U> & solver = *Getters::GetT(L);
+					bool bDone = solver.step(luaL_optint(L, 2, 0), luaL_optnumber(L, 3, 0));
+
+					lua_pushboolean(L, bDone ? 1 : 0);	// solver[, iterations[, microseconds]], done
+
+					return 1 + LuaXS::PushArgAndReturn(L, solver.iterations());	// solver[, iterations[, microseconds]], done, iterations
+				}
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(tolerance)
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+template<typename T> struct AuxTypeName<IterativeSolver<T>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "IterativeSolver<");
+
+		AuxTypeName<T>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
@@ -0,0 +1,298 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "types.h"
+#include "utils.h"
+#include "macros.h"
+#include "distance_ops.h"
+
+namespace detail_kmeans {
+	// k-means over the rows of a matrix: k-means++ seeding, followed by Lloyd or mini-batch
+	// iterations. Distances are found a tile at a time, as in pairwiseSquaredDistances().
+	template<typename R> struct KMeans {
+		using Scalar = typename R::Scalar;
+		using Ref = typename MatrixRef<R>::Type;
+		using Distances = detail_distance::PairwiseDistances<R>;
+
+		enum { kTile = Distances::kTileA };
+
+		const Ref & mData;	// Observations, one per row
+		R mCentroids;	// Current cluster centers, one per row
+		Eigen::VectorXi mLabels;// Cluster of each observation (0-based while working)
+		std::mt19937 mGen;	// Random source for seeding and sampling
+		Scalar mTolerance{Scalar(1e-4)};// Stop once no center moves farther than this (relative to the data's scale)
+		Scalar mInertia{0};	// Sum of squared distances from observations to their centers
+		int mMaxIterations{100};// Iteration limit
+		int mBatchSize{0};	// Observations per mini-batch, or 0 for full Lloyd iterations
+		int mIterations{0};	// Iterations performed
+		bool mThreaded{false};	// Split assignment and update among threads? (A hint, honored only in OpenMP builds)
+
+		KMeans (const Ref & data, Eigen::Index k, unsigned int seed) : mData(data), mCentroids{k, data.cols()}, mLabels{data.rows()}, mGen{seed}
+		{
+		}
+
+		// Choose initial centers, each new one drawn with probability proportional to its squared
+		// distance from the nearest center chosen so far.
+		void Seed (void)
+		{
+			Eigen::Index n = mData.rows();
+			ColVector<Scalar> d2{n};
+
+			mCentroids.row(0) = mData.row(std::uniform_int_distribution<Eigen::Index>{0, n - 1}(mGen));
+
+			d2 = (mData.rowwise() - mCentroids.row(0)).rowwise().squaredNorm();
+
+			for (Eigen::Index c = 1; c < mCentroids.rows(); ++c)
+			{
+				Scalar total = d2.sum();
+				Eigen::Index i = 0;
+
+				if (total > Scalar(0))
+				{
+					Scalar pick = std::uniform_real_distribution<Scalar>{Scalar(0), total}(mGen);
+
+					for (Scalar sum = d2(0); sum < pick && i + 1 < n; sum += d2(++i));
+				}
+
+				else i = std::uniform_int_distribution<Eigen::Index>{0, n - 1}(mGen);
+
+				mCentroids.row(c) = mData.row(i);
+
+				d2 = d2.cwiseMin((mData.rowwise() - mCentroids.row(c)).rowwise().squaredNorm());
+			}
+		}
+
+		// Label each observation with its nearest center, returning the inertia.
+		Scalar Assign (void)
+		{
+			Ref centroids{mCentroids};
+			Distances dist{mData, centroids};
+			Eigen::Index n = mData.rows();
+			Scalar inertia = 0;
+
+			#ifdef _OPENMP
+			#pragma omp parallel for reduction(+ : inertia) if (mThreaded)
+			#endif
+			for (Eigen::Index i = 0; i < n; i += kTile)
+			{
+				Eigen::Index count = (std::min)(Eigen::Index(kTile), n - i);
+				R tile;
+
+				dist.Tile(tile, i, count, 0, mCentroids.rows());
+
+				for (Eigen::Index r = 0; r < count; ++r)
+				{
+					Eigen::Index best;
+
+					inertia += tile.row(r).minCoeff(&best);
+
+					mLabels(i + r) = int(best);
+				}
+			}
+
+			return inertia;
+		}
+
+		// Move each center to the mean of its observations, returning the largest move. Empty
+		// clusters keep their old centers.
+		Scalar Update (void)
+		{
+			Eigen::Index n = mData.rows(), k = mCentroids.rows();
+			R sums = R::Zero(k, mData.cols());
+			Eigen::VectorXi counts = Eigen::VectorXi::Zero(k);
+
+			#ifdef _OPENMP
+			#pragma omp parallel if (mThreaded)
+			#endif
+			{
+				R local_sums = R::Zero(k, mData.cols());
+				Eigen::VectorXi local_counts = Eigen::VectorXi::Zero(k);
+
+				#ifdef _OPENMP
+				#pragma omp for
+				#endif
+				for (Eigen::Index i = 0; i < n; ++i)
+				{
+					local_sums.row(mLabels(i)) += mData.row(i);
+
+					++local_counts(mLabels(i));
+				}
+
+				#ifdef _OPENMP
+				#pragma omp critical
+				#endif
+				{
+					sums += local_sums;
+					counts += local_counts;
+				}
+			}
+
+			Scalar shift = 0;
+
+			for (Eigen::Index c = 0; c < k; ++c)
+			{
+				if (!counts(c)) continue;
+
+				auto center = sums.row(c) / Scalar(counts(c));
+
+				shift = (std::max)(shift, (center - mCentroids.row(c)).squaredNorm());
+
+				mCentroids.row(c) = center;
+			}
+
+			return std::sqrt(shift);
+		}
+
+		// Mini-batch step: assign a random sample, then pull each center toward its members with
+		// a per-center rate of 1 / (number of observations seen so far).
+		Scalar MiniBatch (Eigen::VectorXi & seen)
+		{
+			std::uniform_int_distribution<Eigen::Index> pick{0, mData.rows() - 1};
+			R batch{mBatchSize, mData.cols()}, before = mCentroids;
+
+			for (int i = 0; i < mBatchSize; ++i) batch.row(i) = mData.row(pick(mGen));
+
+			typename MatrixRef<R>::Type bref{batch}, centroids{mCentroids};
+			R tile;
+
+			Distances{bref, centroids}.Tile(tile, 0, mBatchSize, 0, mCentroids.rows());
+
+			for (int i = 0; i < mBatchSize; ++i)
+			{
+				Eigen::Index c;
+
+				tile.row(i).minCoeff(&c);
+
+				Scalar eta = Scalar(1) / Scalar(++seen(c));
+
+				mCentroids.row(c) += eta * (batch.row(i) - mCentroids.row(c));
+			}
+
+			return std::sqrt((mCentroids - before).rowwise().squaredNorm().maxCoeff());
+		}
+
+		void Run (void)
+		{
+			Seed();
+
+			Scalar scale = std::sqrt((mData.rowwise() - mData.colwise().mean()).rowwise().squaredNorm().mean());
+			Eigen::VectorXi seen = Eigen::VectorXi::Zero(mCentroids.rows());
+
+			for (mIterations = 0; mIterations < mMaxIterations; )
+			{
+				Scalar shift;
+
+				++mIterations;
+
+				if (mBatchSize > 0) shift = MiniBatch(seen);
+
+				else
+				{
+					Assign();
+
+					shift = Update();
+				}
+
+				if (shift <= mTolerance * scale) break;
+			}
+
+			mInertia = Assign();
+		}
+	};
+
+	// Cluster rows: data, k[, opts]; opts may supply maxIterations, tolerance, batchSize, seed,
+	// and threaded. Returns the centroids (k x cols), 1-based int labels, and the inertia.
+	template<typename R> static int Cluster (lua_State * L)
+	{
+		MatrixRef<R> data{L, 1};
+		Eigen::Index k = LuaXS::Int(L, 2);
+
+		luaL_argcheck(L, k > 0 && k <= data->rows(), 2, "k must be between 1 and the number of rows");
+
+		auto td = TypeData<Eigen::MatrixXi>::Get(L, GetTypeData::eFetchIfMissing);
+
+		luaL_argcheck(L, td, 1, "kmeans() requires int matrices");
+
+		unsigned int seed = std::mt19937::default_seed;
+
+		if (lua_istable(L, 3))
+		{
+			lua_getfield(L, 3, "seed");	// data, k, opts, seed
+
+			if (!lua_isnil(L, -1)) seed = (unsigned int)luaL_checknumber(L, -1);
+
+			lua_pop(L, 1);	// data, k, opts
+		}
+
+		KMeans<R> km{*data, k, seed};
+
+		if (lua_istable(L, 3))
+		{
+			lua_getfield(L, 3, "maxIterations");// data, k, opts, max_iterations
+			lua_getfield(L, 3, "tolerance");// data, k, opts, max_iterations, tolerance
+			lua_getfield(L, 3, "batchSize");// data, k, opts, max_iterations, tolerance, batch_size
+			lua_getfield(L, 3, "threaded");	// data, k, opts, max_iterations, tolerance, batch_size, threaded
+
+			km.mMaxIterations = luaL_optint(L, -4, km.mMaxIterations);
+			km.mTolerance = typename R::Scalar(luaL_optnumber(L, -3, km.mTolerance));
+			km.mBatchSize = luaL_optint(L, -2, 0);
+			km.mThreaded = lua_toboolean(L, -1) != 0;
+
+			lua_pop(L, 4);	// data, k, opts
+		}
+
+		km.Run();
+
+		Eigen::MatrixXi labels = km.mLabels.array() + 1;
+
+		New<R>(L, std::move(km.mCentroids));	// data, k[, opts], centroids
+
+		PUSH_TYPED_DATA_NO_RET(labels);	// data, k[, opts], centroids, labels
+
+		lua_pushnumber(L, km.mInertia);	// data, k[, opts], centroids, labels, inertia
+
+		return 3;
+	}
+}
+
+// Methods assigned when the underlying type is real floating point.
+template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsInteger && !Eigen::NumTraits<typename T::Scalar>::IsComplex> struct ClusterOps {
+	ClusterOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"kmeans", detail_kmeans::Cluster<R>
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// No-op for integer and complex types.
+template<typename T, typename R> struct ClusterOps<T, R, false> {
+	ClusterOps (lua_State *) {}
+};
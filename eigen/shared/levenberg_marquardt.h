@@ -0,0 +1,281 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "solver_base.h"
+
+// Damped Gauss-Newton (Levenberg-Marquardt) minimizer of 0.5 * |r(x)|^2. Residuals and their
+// Jacobian are produced by a caller-supplied evaluator that fills whole matrices at once, or
+// the Jacobian is estimated by forward differences. The damping follows Marquardt's scaling by
+// the diagonal of J^T * J, with Nielsen's update of the damping factor after each step.
+template<typename R> struct LevenbergMarquardt {
+	using Scalar = typename R::Scalar;
+	using Vector = ColVector<Scalar>;
+
+	R mHessian;	// Gauss-Newton approximation J^T * J at the current point
+	Vector mGradient;	// J^T * r at the current point
+	Scalar mCost{0};	// 0.5 * |r|^2 at the current point
+	Scalar mTolerance{Eigen::NumTraits<Scalar>::dummy_precision()};	// Gradient and step tolerance
+	Eigen::Index mResidualCount;// Number of residuals
+	Eigen::ComputationInfo mInfo{Eigen::Success};	// Outcome of the most recent minimization
+	int mMaxIterations{100};// Iteration limit
+	int mIterations{0};	// Iterations taken by the most recent minimization
+	bool mFiniteDifference;	// Is the Jacobian estimated, rather than supplied?
+
+	LevenbergMarquardt (Eigen::Index m, bool bFiniteDifference) : mResidualCount{m}, mFiniteDifference{bFiniteDifference}
+	{
+	}
+
+	// Evaluate residuals at the trial point, rejecting non-finite results.
+	template<typename F> bool Residuals (const R & r, F && evaluate)
+	{
+		return evaluate() && r.allFinite();
+	}
+
+	// Estimate the Jacobian by forward differences, with the residuals at the trial point in r.
+	// Fails if any perturbed point is unusable; the trial point and residuals are restored either way.
+	template<typename F> bool Differences (R & trial, R & r, R & J, F && evaluate)
+	{
+		const Scalar eps = std::sqrt(Eigen::NumTraits<Scalar>::epsilon());
+		R r0 = r;
+		bool bOK = true;
+
+		for (Eigen::Index j = 0; j < trial.rows() && bOK; ++j)
+		{
+			Scalar xj = trial(j, 0), h = eps * (std::max)(std::abs(xj), Scalar(1));
+
+			trial(j, 0) = xj + h;
+
+			bOK = Residuals(r, evaluate);
+
+			if (bOK) J.col(j) = (r - r0) / h;
+
+			trial(j, 0) = xj;
+		}
+
+		r = r0;
+
+		return bOK;
+	}
+
+	// Refresh the Gauss-Newton terms from the residuals and Jacobian at an accepted point.
+	void Linearize (const R & r, const R & J)
+	{
+		mHessian.noalias() = J.transpose() * J;
+		mGradient.noalias() = J.transpose() * r;
+		mCost = r.squaredNorm() / 2;
+	}
+
+	// Minimize from the starting point x, which receives the result. The evaluator reads the trial
+	// point and fills r (and J, unless differencing), returning false if the point is unusable.
+	template<typename F> void Minimize (R & x, R & trial, R & r, R & J, F && evaluate)
+	{
+		mIterations = 0;
+		mInfo = Eigen::NumericalIssue;
+
+		trial = x;
+
+		if (!Residuals(r, evaluate)) return;
+		if (mFiniteDifference && !Differences(trial, r, J, evaluate)) return;
+
+		Linearize(r, J);
+
+		Scalar lambda = Scalar(1e-3) * (std::max)(mHessian.diagonal().maxCoeff(), Scalar(1)), nu = 2;
+
+		mInfo = Eigen::NoConvergence;
+
+		while (mIterations < mMaxIterations)
+		{
+			if (!mHessian.allFinite())
+			{
+				mInfo = Eigen::NumericalIssue;
+
+				break;
+			}
+
+			else if (mGradient.template lpNorm<Eigen::Infinity>() <= mTolerance)
+			{
+				mInfo = Eigen::Success;
+
+				break;
+			}
+
+			Vector scale = mHessian.diagonal().cwiseMax(Eigen::NumTraits<Scalar>::epsilon());
+			R damped = mHessian;
+
+			damped.diagonal() += lambda * scale;
+
+			Vector dx = damped.ldlt().solve(-mGradient);
+
+			++mIterations;
+
+			if (dx.norm() <= mTolerance * (x.norm() + mTolerance))
+			{
+				mInfo = Eigen::Success;
+
+				break;
+			}
+
+			trial = x + dx;
+
+			// Compare the actual reduction against that predicted by the linear model.
+			Scalar predicted = dx.dot(lambda * scale.cwiseProduct(dx) - mGradient) / 2;
+
+			if (Residuals(r, evaluate))
+			{
+				Scalar rho = (mCost - r.squaredNorm() / 2) / predicted;
+
+				if (rho > 0)
+				{
+					// Without a Jacobian the step cannot continue, so stop at the last accepted point.
+					if (mFiniteDifference && !Differences(trial, r, J, evaluate))
+					{
+						mInfo = Eigen::NumericalIssue;
+
+						break;
+					}
+
+					x = trial;
+
+					Linearize(r, J);
+
+					Scalar t = 2 * rho - 1;
+
+					lambda *= (std::max)(Scalar(1) / 3, 1 - t * t * t);
+					nu = 2;
+
+					continue;
+				}
+			}
+
+			lambda *= nu;
+			nu *= 2;
+
+			if (!std::isfinite(lambda))
+			{
+				mInfo = Eigen::NumericalIssue;
+
+				break;
+			}
+		}
+	}
+
+	Scalar cost (void) const { return mCost; }
+	Eigen::ComputationInfo info (void) const { return mInfo; }
+	int iterations (void) const { return mIterations; }
+	int maxIterations (void) const { return mMaxIterations; }
+	Scalar tolerance (void) const { return mTolerance; }
+
+	void setMaxIterations (int count) { mMaxIterations = count; }
+	void setTolerance (Scalar tolerance) { mTolerance = tolerance; }
+};
+
+/*****************************
+* LevenbergMarquardt methods *
+*****************************/
+template<typename U, typename R> struct AttachMethods<LevenbergMarquardt<U>, R> : SolverMethodsBase<LevenbergMarquardt<U>, R> {
+	using Getters = InstanceGetters<LevenbergMarquardt<U>, R>;
+	using Scalar = typename LevenbergMarquardt<U>::Scalar;
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(cost)
+			}, {
+				"info", SolverMethodsBase<LevenbergMarquardt<U>, R>::template Info<>
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(iterations)
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(maxIterations)
+			}, {
+				// x, func: x is a column vector of starting parameters, updated with the solution. The
+				// function is called as func(x, r, J), or func(x, r) when differencing, and should fill
+				// the residuals r and Jacobian J in place; a false result rejects the point.
+				"minimize", [](lua_State * L)
+				{
+					LevenbergMarquardt<U> & lm = *Getters::GetT(L);
+					WritableMatrixRef<R> xref{L, 2};
+
+					luaL_argcheck(L, xref->cols() == 1, 2, "Parameters must be a column vector");
+					luaL_checktype(L, 3, LUA_TFUNCTION);
+					lua_settop(L, 3);	// lm, x, func
+
+					Eigen::Index n = xref->rows();
+					R x = *xref;
+					R & trial = *New<R>(L, n, 1);	// lm, x, func, trial
+					R & r = *New<R>(L, lm.mResidualCount, 1);	// lm, x, func, trial, r
+					R & J = *New<R>(L, lm.mResidualCount, n);	// lm, x, func, trial, r, J
+
+					lm.Minimize(x, trial, r, J, [L, &lm]() {
+						lua_pushvalue(L, 3);// lm, x, func, trial, r, J, func
+						lua_pushvalue(L, 4);// lm, x, func, trial, r, J, func, trial
+						lua_pushvalue(L, 5);// lm, x, func, trial, r, J, func, trial, r
+
+						if (!lm.mFiniteDifference) lua_pushvalue(L, 6);	// lm, x, func, trial, r, J, func, trial, r[, J]
+
+						lua_call(L, lm.mFiniteDifference ? 2 : 3, 1);	// lm, x, func, trial, r, J, ok
+
+						bool ok = !lua_isboolean(L, -1) || lua_toboolean(L, -1);
+
+						lua_pop(L, 1);	// lm, x, func, trial, r, J
+
+						return ok;
+					});
+
+					*xref = x;
+
+					lua_pushvalue(L, 2);// lm, x, func, trial, r, J, x
+
+					return 1 + LuaXS::PushArgAndReturn(L, lm.iterations());	// lm, x, func, trial, r, J, x, iterations
+				}
+			}, {
+				"setMaxIterations", SolverMethodsBase<LevenbergMarquardt<U>, R>::template SetMaxIterations<>
+			}, {
+				"setTolerance", [](lua_State * L)
+				{
+					Getters::GetT(L)->setTolerance(LuaXS::GetArg<Scalar>(L, 2));
+
+					return SelfForChaining(L);	// lm, tolerance, lm
+				}
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(tolerance)
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+template<typename T> struct AuxTypeName<LevenbergMarquardt<T>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "LevenbergMarquardt<");
+
+		AuxTypeName<T>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "solver_base.h"
+#include "permutation.h"
 
 //
 template<typename U, typename R> struct LUMethodsBase : SolverMethodsBase<U, R> {
@@ -39,7 +40,7 @@ template<typename U, typename R> struct LUMethodsBase : SolverMethodsBase<U, R>
 			}, {
 				EIGEN_MATRIX_GET_MATRIX_METHOD(matrixLU)
 			}, {
-				EIGEN_MATRIX_GET_MATRIX_METHOD(permutationP)
+				EIGEN_PERMUTATION_METHOD(permutationP, PermutationOf)
 			}, {
 				EIGEN_MATRIX_PUSH_VALUE_METHOD(rcond)
 			}, {
@@ -73,7 +74,7 @@ template<typename U, typename R> struct AttachMethods<Eigen::FullPivLU<U>, R> :
 			}, {
 				EIGEN_MATRIX_GET_MATRIX_METHOD(kernel)
 			}, {
-				EIGEN_MATRIX_GET_MATRIX_METHOD(permutationQ)
+				EIGEN_PERMUTATION_METHOD(permutationQ, PermutationOf)
 			},
 			{ nullptr, nullptr }
 		};
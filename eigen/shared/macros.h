@@ -24,16 +24,18 @@
 #pragma once
 
 //
-#define EIGEN_REL_OP(OP)	return Getters::WithArray(L, [L](const ArrayType & arr) {               \
-								if (!HasType<T>(L, 2))                                              \
-								{                                                                   \
-									ArgObjectR<R> ao{L, 2};                                         \
-                                                                                                    \
-									if (ao.mObject) New<BoolMatrix>(L, arr OP ao.mObject->array()); \
-									else New<BoolMatrix>(L, arr OP ao.mScalar);                     \
-								}                                                                   \
-                                                                                                    \
-								else New<BoolMatrix>(L, arr OP Getters::GetR(L, 2).array());        \
+#define EIGEN_REL_OP(OP)	return Getters::WithArray(L, [L](const ArrayType & arr) {                   \
+								bool bPacked = WantsBool(L, "Packed", 3);                               \
+                                                                                                        \
+								if (!HasType<T>(L, 2))                                                  \
+								{                                                                       \
+									ArgObjectR<R> ao{L, 2};                                             \
+                                                                                                        \
+									if (ao.mObject) NewMask(L, arr OP ao.mObject->array(), bPacked);    \
+									else NewMask(L, arr OP ao.mScalar, bPacked);                        \
+								}                                                                       \
+                                                                                                        \
+								else NewMask(L, arr OP Getters::GetR(L, 2).array(), bPacked);           \
 							})
 							
 //
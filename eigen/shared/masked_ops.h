@@ -0,0 +1,324 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+#include "bit_matrix.h"
+
+//
+namespace detail_masked {
+	// Built-in predicates. The comparisons take a scalar operand; of those, only the equality
+	// tests are available to complex matrices.
+	enum Pred { eLess, eLessEqual, eGreater, eGreaterEqual, eEqual, eNotEqual, eFinite, eNaN, eBits, eBools };
+
+	static const char * sPredNames[] = { "<", "<=", ">", ">=", "==", "~=", "isFinite", "isNaN", nullptr };
+
+	// Call a function on each coefficient accepted by a predicate, in storage order.
+	template<typename M, typename P, typename F> void Each (const M & m, P && pred, F && func)
+	{
+		for (Eigen::Index j = 0; j < m.cols(); ++j)
+		{
+			for (Eigen::Index i = 0; i < m.rows(); ++i)
+			{
+				if (pred(i, j)) func(i, j);
+			}
+		}
+	}
+
+	// Ordering predicates, when the underlying type is real.
+	template<typename S, bool = Eigen::NumTraits<S>::IsComplex> struct Ordered {
+		template<typename M, typename F> static void Each (lua_State *, Pred pred, const M & m, S s, F && func)
+		{
+			switch (pred)
+			{
+			case eLess:
+				detail_masked::Each(m, [&m, s](Eigen::Index i, Eigen::Index j) { return m.coeff(i, j) < s; }, func);
+				break;
+			case eLessEqual:
+				detail_masked::Each(m, [&m, s](Eigen::Index i, Eigen::Index j) { return m.coeff(i, j) <= s; }, func);
+				break;
+			case eGreater:
+				detail_masked::Each(m, [&m, s](Eigen::Index i, Eigen::Index j) { return m.coeff(i, j) > s; }, func);
+				break;
+			default:
+				detail_masked::Each(m, [&m, s](Eigen::Index i, Eigen::Index j) { return m.coeff(i, j) >= s; }, func);
+			}
+		}
+	};
+
+	template<typename S> struct Ordered<S, true> {
+		template<typename M, typename F> static void Each (lua_State * L, Pred, const M &, S, F &&)
+		{
+			luaL_error(L, "Ordering predicates require a real matrix");
+		}
+	};
+
+	// Selection of coefficients, given by a BoolMatrix, BitMatrix, or built-in predicate name
+	// (followed by its scalar operand, if it takes one) at some stack position.
+	template<typename R> struct Where {
+		using S = typename R::Scalar;
+
+		MatrixRef<BoolMatrix> mBools;	// Mask, if unpacked
+		const BitMatrix * mBits{nullptr};	// Mask, if packed
+		Pred mPred;	// How coefficients are selected
+		S mOperand{0};	// Operand of comparison predicates
+		int mArg, mNext;// Stack position of selection; first position after it
+
+		Where (lua_State * L, int arg) : mArg{arg}, mNext{arg + 1}
+		{
+			if (lua_type(L, arg) == LUA_TSTRING)
+			{
+				mPred = Pred(luaL_checkoption(L, arg, nullptr, sPredNames));
+
+				if (mPred < eFinite) mOperand = AsScalar<R>(L, mNext++);
+			}
+
+			else if (HasType<BitMatrix>(L, arg))
+			{
+				mBits = LuaXS::UD<BitMatrix>(L, arg);
+				mPred = eBits;
+			}
+
+			else
+			{
+				mBools.Init(L, arg);
+
+				mPred = eBools;
+			}
+		}
+
+		template<typename M> void CheckDims (lua_State * L, const M & m, Eigen::Index rows, Eigen::Index cols) const
+		{
+			luaL_argcheck(L, m.rows() == rows && m.cols() == cols, mArg, "Mask dimensions do not match matrix");
+		}
+
+		// Call a function on each selected coefficient of the matrix.
+		template<typename M, typename F> void Visit (lua_State * L, const M & m, F && func) const
+		{
+			S s = mOperand;
+
+			switch (mPred)
+			{
+			case eBits:
+				{
+					const BitMatrix & bits = *mBits;
+
+					CheckDims(L, m, bits.rows(), bits.cols());
+					Each(m, [&bits](Eigen::Index i, Eigen::Index j) { return bits(i, j); }, func);
+				}
+				break;
+			case eBools:
+				{
+					const BoolMatrixRef & bools = *mBools;
+
+					CheckDims(L, m, bools.rows(), bools.cols());
+					Each(m, [&bools](Eigen::Index i, Eigen::Index j) { return bools.coeff(i, j); }, func);
+				}
+				break;
+			case eEqual:
+				Each(m, [&m, s](Eigen::Index i, Eigen::Index j) { return m.coeff(i, j) == s; }, func);
+				break;
+			case eNotEqual:
+				Each(m, [&m, s](Eigen::Index i, Eigen::Index j) { return m.coeff(i, j) != s; }, func);
+				break;
+			case eFinite:
+				Each(m, [&m](Eigen::Index i, Eigen::Index j) { return (Eigen::numext::isfinite)(m.coeff(i, j)); }, func);
+				break;
+			case eNaN:
+				Each(m, [&m](Eigen::Index i, Eigen::Index j) { return (Eigen::numext::isnan)(m.coeff(i, j)); }, func);
+				break;
+			default:
+				Ordered<S>::Each(L, mPred, m, s, func);
+			}
+		}
+	};
+
+	// Common body of masked updates: where, valueOrMatrix. The operation is given the output
+	// coefficient and the corresponding value.
+	template<typename R, typename OP> static int Update (lua_State * L, OP op)
+	{
+		WritableMatrixRef<R> m{L, 1};
+		Where<R> where{L, 2};
+		ArgObjectR<R> ao{L, where.mNext};
+		auto & out = *m;
+
+		if (ao.mObject)
+		{
+			const R & other = *ao.mObject;
+
+			luaL_argcheck(L, other.rows() == out.rows() && other.cols() == out.cols(), where.mNext, "Operand dimensions do not match matrix");
+
+			where.Visit(L, out, [&out, &other, &op](Eigen::Index i, Eigen::Index j) { op(out.coeffRef(i, j), other.coeff(i, j)); });
+		}
+
+		else
+		{
+			typename R::Scalar s = ao.mScalar;
+
+			where.Visit(L, out, [&out, s, &op](Eigen::Index i, Eigen::Index j) { op(out.coeffRef(i, j), s); });
+		}
+
+		lua_settop(L, 1);	// m
+
+		return 1;
+	}
+
+	// Extreme value among the selected coefficients, or nil if none were selected.
+	template<typename R, bool bMax> static int Extreme (lua_State * L)
+	{
+		using S = typename R::Scalar;
+
+		MatrixRef<R> m{L, 1};
+		Where<R> where{L, 2};
+		S best{0};
+		bool bAny = false;
+
+		where.Visit(L, *m, [&m, &best, &bAny](Eigen::Index i, Eigen::Index j) {
+			S x = m->coeff(i, j);
+
+			if (!bAny || (bMax ? x > best : x < best)) best = x;
+
+			bAny = true;
+		});
+
+		if (!bAny) lua_pushnil(L);	// m, ..., nil
+
+		else LuaXS::PushArg(L, best);	// m, ..., extreme
+
+		return 1;
+	}
+
+	// Count and sum of the selected coefficients.
+	template<typename R> static Eigen::Index Sum (lua_State * L, typename R::Scalar & sum)
+	{
+		MatrixRef<R> m{L, 1};
+		Where<R> where{L, 2};
+		Eigen::Index n = 0;
+
+		sum = typename R::Scalar(0);
+
+		where.Visit(L, *m, [&m, &sum, &n](Eigen::Index i, Eigen::Index j) {
+			sum += m->coeff(i, j);
+
+			++n;
+		});
+
+		return n;
+	}
+}
+
+// Methods assigned when the underlying type is real.
+template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsComplex> struct MaskedRealOps {
+	MaskedRealOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"maxWhere", detail_masked::Extreme<R, true>
+			}, {
+				"minWhere", detail_masked::Extreme<R, false>
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// No-op for complex types.
+template<typename T, typename R> struct MaskedRealOps<T, R, false> {
+	MaskedRealOps (lua_State *) {}
+};
+
+// Masked updates and reductions, each done in one pass. The selection is a BoolMatrix or
+// BitMatrix mask, or else one of the built-in predicates, e.g. m:sumWhere(">", 0).
+template<typename T, typename R> struct MaskedOps {
+	using Scalar = typename R::Scalar;
+
+	MaskedOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"addWhere", [](lua_State * L)
+				{
+					return detail_masked::Update<R>(L, [](Scalar & x, Scalar v) { x += v; });
+				}
+			}, {
+				"countWhere", [](lua_State * L)
+				{
+					MatrixRef<R> m{L, 1};
+					detail_masked::Where<R> where{L, 2};
+					Eigen::Index n = 0;
+
+					where.Visit(L, *m, [&n](Eigen::Index, Eigen::Index) { ++n; });
+
+					return LuaXS::PushArgAndReturn(L, n);
+				}
+			}, {
+				"meanWhere", [](lua_State * L)
+				{
+					Scalar sum;
+					Eigen::Index n = detail_masked::Sum<R>(L, sum);
+
+					if (n == 0) lua_pushnil(L);	// m, ..., nil
+
+					else LuaXS::PushArg(L, Scalar(sum / Scalar(n)));// m, ..., mean
+
+					return 1;
+				}
+			}, {
+				"mulWhere", [](lua_State * L)
+				{
+					return detail_masked::Update<R>(L, [](Scalar & x, Scalar v) { x *= v; });
+				}
+			}, {
+				"setWhere", [](lua_State * L)
+				{
+					return detail_masked::Update<R>(L, [](Scalar & x, Scalar v) { x = v; });
+				}
+			}, {
+				"subWhere", [](lua_State * L)
+				{
+					return detail_masked::Update<R>(L, [](Scalar & x, Scalar v) { x -= v; });
+				}
+			}, {
+				"sumWhere", [](lua_State * L)
+				{
+					Scalar sum;
+
+					detail_masked::Sum<R>(L, sum);
+
+					return LuaXS::PushArgAndReturn(L, sum);
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+
+		MaskedRealOps<T, R> mro{L};
+	}
+};
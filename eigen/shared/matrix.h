@@ -27,11 +27,22 @@
 #include "types.h"
 #include "utils.h"
 #include "macros.h"
+#include "bit_matrix.h"
 #include "xprs.h"
 #include "arith_ops.h"
+#include "distance_ops.h"
+#include "gather_ops.h"
+#include "kmeans.h"
+#include "masked_ops.h"
+#include "half_ops.h"
+#include "matrix_functions.h"
+#include "pipeline_ops.h"
 #include "real_ops.h"
+#include "simd_dispatch.h"
 #include "solver_ops.h"
+#include "sort_ops.h"
 #include "stock_ops.h"
+#include "transform_ops.h"
 #include "unary_view.h"
 #include "write_ops.h"
 #include "xpr_ops.h"
@@ -52,7 +63,16 @@ namespace detail_matrix {
         }
     };
     
-    template<typename T, typename R, typename U> struct Cast {
+    // Half-precision coefficients only convert directly to float and double, so are widened to
+    // float on the way to any other type.
+    template<typename T, typename U> struct CastFromHalf {
+        static MatrixOf<U> Do (lua_State * L)
+        {
+            return InstanceGetters<T, HalfMatrix>::GetT(L)->template cast<float>().template cast<U>();
+        }
+    };
+
+    template<typename T, typename R, typename U, typename C = CastTo<T, R, U>> struct Cast {
 		using MT = MatrixOf<U>;
 
 		Cast (lua_State * L)
@@ -61,7 +81,7 @@ namespace detail_matrix {
 
 			luaL_argcheck(L, td, 2, "Matrix type unavailable for cast");
 
-            MT m = CastTo<T, R, U>::Do(L);
+            MT m = C::Do(L);
 
 			if (td->mDatum) *static_cast<MT *>(td->mDatum) = m;
 
@@ -103,14 +123,49 @@ namespace detail_matrix {
 	// 
 	template<typename T, typename R> struct AddComplexComponentViews<T, R, true, true> {
 		using Getters = InstanceGetters<T, R>;
+		using Real = typename Eigen::NumTraits<typename T::Scalar>::Real;
+
+		// Push the real or imaginary parts as a strided map over the complex storage, usable as any
+		// other real matrix, if the real family is loaded. Otherwise, a unary view is pushed.
+		template<bool bImag, bool = IsLvalue<T>::value> struct Component {
+			static int Push (lua_State * L)
+			{
+				T & m = *Getters::GetT(L);
+				auto td = TypeData<MatrixOf<Real>>::Get(L, GetTypeData::eFetchIfMissing);
+
+				if (td && td->mPushComponentView && m.innerStride() == 1)
+				{
+					Real * data = reinterpret_cast<Real *>(m.data()) + (bImag ? 1 : 0);
+
+					return td->mPushComponentView(L, data, m.rows(), m.cols(), m.outerStride());	// m, view
+				}
+
+				else return Component<bImag, false>::Push(L);
+			}
+		};
+
+		template<bool bImag> struct Component<bImag, false> {
+			static int Push (lua_State * L)
+			{
+				if (bImag)
+				{
+					EIGEN_PUSH_AUTO_RESULT(imag);
+				}
+
+				else
+				{
+					EIGEN_PUSH_AUTO_RESULT(real);
+				}
+			}
+		};
 
 		AddComplexComponentViews (lua_State * L)
 		{
 			luaL_Reg methods[] = {
 				{
-					EIGEN_PUSH_AUTO_RESULT_METHOD(imag)
+					"imag", Component<true>::Push
 				}, {
-					EIGEN_PUSH_AUTO_RESULT_METHOD(real)
+					"real", Component<false>::Push
 				},
 				{ nullptr, nullptr }
 			};
@@ -190,8 +245,8 @@ namespace detail_matrix {
 				}, {
 					"cast", [](lua_State * L)
 					{
-						const char * names[] = { "int", "float", "double", "cfloat", "cdouble", nullptr };
-						ScalarType types[] = { eInt, eFloat, eDouble, eCfloat, eCdouble };
+						const char * names[] = { "int", "float", "double", "cfloat", "cdouble", "int64", "int16", "uint8", "half", nullptr };
+						ScalarType types[] = { eInt, eFloat, eDouble, eCfloat, eCdouble, eInt64, eInt16, eUint8, eHalf };
 
 						switch (types[luaL_checkoption(L, 2, nullptr, names)])
 						{
@@ -210,6 +265,18 @@ namespace detail_matrix {
 						case eCdouble:
 							detail_matrix::Cast<T, R, std::complex<double>>{L};	// mat, type, cdm
 							break;
+						case eInt64:
+							detail_matrix::Cast<T, R, int64_t>{L};	// mat, type, i64m
+							break;
+						case eInt16:
+							detail_matrix::Cast<T, R, int16_t>{L};	// mat, type, i16m
+							break;
+						case eUint8:
+							detail_matrix::Cast<T, R, uint8_t>{L};	// mat, type, u8m
+							break;
+						case eHalf:
+							detail_matrix::Cast<T, R, Eigen::half>{L};	// mat, type, hm
+							break;
                         default:
                             luaL_error(L, "Bad type");
 						}
@@ -361,11 +428,20 @@ namespace detail_matrix {
 			luaL_register(L, nullptr, methods);
 
 			ArithOps<T, R> arith_ops{L};
+			ClusterOps<T, R> cluster_ops{L};
+			DistanceOps<T, R> distance_ops{L};
+			GatherOps<T, R> gather_ops{L};
+			MaskedOps<T, R> masked_ops{L};
+			MatrixFunctionOps<T, R> mfo{L};
+			PipelineOps<T, R> po{L};
 			RealOps<T, R> real_ops{L};
 			SolverOps<T, R> solver_ops{L};
+			SortOps<T, R> sort_ops{L};
 			StockOps<T, R> so{L};
+			TransformOps<T, R> to{L};
 			WriteOps<T, R> wo{L};
 			XprOps<T, R> xo{L};
+			SimdOps<T, R> simd_ops{L};	// last, to replace generic methods
 
 			AddComplexComponentViews<T, R> accv{L};
 		}
@@ -395,28 +471,18 @@ namespace detail_matrix {
 					}
 				}, {
 					EIGEN_MATRIX_PUSH_VALUE_METHOD(count)
+				}, {
+					"pack", [](lua_State * L)
+					{
+						return NewRet<BitMatrix>(L, BitMatrix{*Getters::GetT(L)});
+					}
 				}, {
 					"select", [](lua_State * L)
 					{
-						// For non-matrix objects such as maps, make a temporary and pass it
-						// along to the select function. (Resolving this in the select logic
-						// itself seems to cause major compilation slowdown.)
-						ArgObjectR<BoolMatrix> bm{L, 1};
-
-						if (!std::is_same<T, BoolMatrix>::value)
-						{
-							lua_pushlightuserdata(L, bm.mObject);	// mat, then, else, conv_mat
-							lua_replace(L, 1);	// conv_mat, then, else
-						}
-
-						// Invoke the select logic appropriate to the supplied objects.
-						GetTypeData * td1 = GetTypeData::FromObject(L, 2);
-						GetTypeData * td2 = GetTypeData::FromObject(L, 3);
-
-						luaL_argcheck(L, td1 || td2, 2, "Two scalars supplied to select()");
-						luaL_argcheck(L, !td1 || !td2 || td1->GetName() == td2->GetName(), 2, "Mixed types supplied to select()");
+						bool bThen, bElse;
+						auto & funcs = GetTypeData::GetSelectFuncs(L, bThen, bElse);
 
-						return (td1 ? td1 : td2)->Select(L);	// selection
+						return funcs.mWithMask(L, *MatrixRef<BoolMatrix>{L, 1}, bThen, bElse);	// bm, then, else, selection
 					}
 				},
 				{ nullptr, nullptr }
@@ -431,6 +497,84 @@ namespace detail_matrix {
 		#endif
 		}
 	};
+
+	// Half-precision matrices are storage only, so rather than the full suite they get access,
+	// conversion, and the float-accumulating kernels in HalfOps.
+	template<typename T> struct AttachBody<T, HalfMatrix> {
+		using Getters = InstanceGetters<T, HalfMatrix>;
+
+		AttachBody (lua_State * L)
+		{
+			luaL_Reg methods[] = {
+				{
+					"asBytes", AsBytes<T>
+				}, {
+					"asMatrix", AsMatrix<T, HalfMatrix>
+				}, {
+					"__call", Call<T>
+				}, {
+					"cast", [](lua_State * L)
+					{
+						const char * names[] = { "int", "float", "double", "cfloat", "cdouble", "int64", "int16", "uint8", "half", nullptr };
+						ScalarType types[] = { eInt, eFloat, eDouble, eCfloat, eCdouble, eInt64, eInt16, eUint8, eHalf };
+
+						switch (types[luaL_checkoption(L, 2, nullptr, names)])
+						{
+						case eInt:
+							detail_matrix::Cast<T, HalfMatrix, int, detail_matrix::CastFromHalf<T, int>>{L};	// mat, type, im
+							break;
+						case eFloat:
+							detail_matrix::Cast<T, HalfMatrix, float>{L};	// mat, type, fm
+							break;
+						case eDouble:
+							detail_matrix::Cast<T, HalfMatrix, double>{L};	// mat, type, dm
+							break;
+						case eCfloat:
+							detail_matrix::Cast<T, HalfMatrix, std::complex<float>, detail_matrix::CastFromHalf<T, std::complex<float>>>{L};	// mat, type, cfm
+							break;
+						case eCdouble:
+							detail_matrix::Cast<T, HalfMatrix, std::complex<double>, detail_matrix::CastFromHalf<T, std::complex<double>>>{L};	// mat, type, cdm
+							break;
+						case eInt64:
+							detail_matrix::Cast<T, HalfMatrix, int64_t, detail_matrix::CastFromHalf<T, int64_t>>{L};	// mat, type, i64m
+							break;
+						case eInt16:
+							detail_matrix::Cast<T, HalfMatrix, int16_t, detail_matrix::CastFromHalf<T, int16_t>>{L};	// mat, type, i16m
+							break;
+						case eUint8:
+							detail_matrix::Cast<T, HalfMatrix, uint8_t, detail_matrix::CastFromHalf<T, uint8_t>>{L};	// mat, type, u8m
+							break;
+						default:
+							return NewRet<HalfMatrix>(L, *Getters::GetT(L));	// mat, type, hm
+						}
+
+						return 1;
+					}
+				}, {
+					EIGEN_MATRIX_PUSH_VALUE_METHOD(cols)
+				}, {
+					"__len", [](lua_State * L)
+					{
+						EIGEN_MATRIX_PUSH_VALUE(size);
+					}
+				}, {
+					EIGEN_MATRIX_PUSH_VALUE_METHOD(rows)
+				}, {
+					EIGEN_MATRIX_PUSH_VALUE_METHOD(size)
+				}, {
+					"__tostring", [](lua_State * L)
+					{
+						return Print(L, *Getters::GetT(L));
+					}
+				},
+				{ nullptr, nullptr }
+			};
+
+			luaL_register(L, nullptr, methods);
+
+			HalfOps<T> ho{L};
+		}
+	};
 }
 
 // Common matrix methods attachment body.
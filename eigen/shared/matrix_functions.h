@@ -0,0 +1,90 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+
+//
+namespace detail_matrix_functions {
+	// Bind a square matrix argument, mapped or otherwise, without copying it.
+	template<typename R> struct SquareArg : MatrixRef<R> {
+		SquareArg (lua_State * L, const char * name) : MatrixRef<R>{L, 1}
+		{
+			if ((*this)->rows() != (*this)->cols()) luaL_error(L, "%s() requires a square matrix", name);
+		}
+	};
+}
+
+// Matrix (as opposed to coefficient-wise) functions, via Eigen's MatrixFunctions module: exp()
+// uses scaling-and-squaring with a Pade approximant, while log(), sqrt() and pow() go through
+// a (complex or real quasi-triangular) Schur decomposition. Real inputs give real results, so
+// the principal value must exist; matrices with eigenvalues on the negative real axis should
+// first be cast to a complex type.
+template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsInteger> struct MatrixFunctionOps {
+	MatrixFunctionOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"matrixExp", [](lua_State * L)
+				{
+					detail_matrix_functions::SquareArg<R> m{L, "matrixExp"};
+
+					return NewRet<R>(L, m->exp());
+				}
+			}, {
+				"matrixLog", [](lua_State * L)
+				{
+					detail_matrix_functions::SquareArg<R> m{L, "matrixLog"};
+
+					return NewRet<R>(L, m->log());
+				}
+			}, {
+				"matrixPow", [](lua_State * L)
+				{
+					detail_matrix_functions::SquareArg<R> m{L, "matrixPow"};
+
+					return NewRet<R>(L, m->pow(typename R::RealScalar(luaL_checknumber(L, 2))));
+				}
+			}, {
+				"matrixSqrt", [](lua_State * L)
+				{
+					detail_matrix_functions::SquareArg<R> m{L, "matrixSqrt"};
+
+					return NewRet<R>(L, m->sqrt());
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// No-op for integer types.
+template<typename T, typename R> struct MatrixFunctionOps<T, R, false> {
+	MatrixFunctionOps (lua_State *) {}
+};
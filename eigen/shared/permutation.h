@@ -0,0 +1,326 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+#include "macros.h"
+#include "gather_ops.h"
+
+// Common form of methods returning a permutation or transpositions. These come back as dense
+// matrices, unless the native form is requested.
+#define EIGEN_PERMUTATION_METHOD(NAME, TYPE)	EIGEN_REG(NAME, if (WantsBool(L, "Native", 2))									\
+												{																			\
+													New<TYPE<R>>(L, Getters::GetT(L)->NAME());	/* object, how, p */		\
+																															\
+													return 1;																\
+												}																			\
+																															\
+												EIGEN_MATRIX_GET_MATRIX(NAME))
+
+// Permutation, stored as indices. It belongs to the family of the matrices it acts upon.
+template<typename R> struct PermutationOf {
+	using Scalar = typename R::Scalar;
+	using Type = Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int>;
+
+	Type mObject;
+
+	template<typename P> explicit PermutationOf (const P & p) : mObject{p}
+	{
+	}
+};
+
+// Sequence of transpositions, e.g. as found by a pivoting decomposition. As with permutations,
+// it belongs to the family of the matrices it acts upon.
+template<typename R> struct TranspositionsOf {
+	using Scalar = typename R::Scalar;
+	using Type = Eigen::Transpositions<Eigen::Dynamic, Eigen::Dynamic, int>;
+
+	Type mObject;
+
+	template<typename P> explicit TranspositionsOf (const P & p) : mObject{p}
+	{
+	}
+};
+
+//
+namespace detail_perm {
+	// Read indices in the form of an int matrix or array, given as a number of entries instead
+	// when the identity is wanted.
+	inline Eigen::VectorXi GetIndices (lua_State * L, int arg, bool bUnique)
+	{
+		if (lua_type(L, arg) == LUA_TNUMBER) return Eigen::VectorXi::LinSpaced(LuaXS::Int(L, arg), 0, LuaXS::Int(L, arg) - 1);
+
+		std::vector<Eigen::Index> indices;
+
+		detail_gather::GetIndices(L, arg, (std::numeric_limits<int>::max)(), indices);
+
+		Eigen::Index n = Eigen::Index(indices.size());
+		std::vector<bool> seen(indices.size(), false);
+		Eigen::VectorXi out(n);
+
+		for (Eigen::Index i = 0; i < n; ++i)
+		{
+			Eigen::Index index = indices[size_t(i)];
+
+			luaL_argcheck(L, index < n, arg, "Index out of range");
+			luaL_argcheck(L, !bUnique || !seen[size_t(index)], arg, "Indices do not form a permutation");
+
+			seen[size_t(index)] = true;
+			out[i] = int(index);
+		}
+
+		return out;
+	}
+
+	// Push indices as an int matrix, converted to 1-based indices.
+	inline int PushIndices (lua_State * L, const Eigen::VectorXi & indices)
+	{
+		auto td = TypeData<Eigen::MatrixXi>::Get(L, GetTypeData::eFetchIfMissing);
+
+		luaL_argcheck(L, td, 1, "indices() requires int matrices");
+
+		Eigen::MatrixXi im = indices.array() + 1;
+
+		PUSH_TYPED_DATA(im);
+	}
+
+	// Methods common to permutations and transpositions, each being applied in O(n) time. The
+	// in-place forms permute the matrix's own storage, without any temporaries.
+	template<typename T, typename R> struct AddCommonMethods {
+		using Getters = InstanceGetters<T, R>;
+
+		AddCommonMethods (lua_State * L)
+		{
+			luaL_Reg methods[] = {
+				{
+					"apply", [](lua_State * L)
+					{
+						return NewRet<R>(L, Getters::GetT(L)->mObject * *MatrixRef<R>{L, 2});	// p, m, pm
+					}
+				}, {
+					"applyInPlace", [](lua_State * L)
+					{
+						WritableMatrixRef<R> m{L, 2};
+
+						luaL_argcheck(L, m->rows() == Getters::GetT(L)->mObject.size(), 2, "Matrix row count does not match size");
+
+						*m = Getters::GetT(L)->mObject * *m;
+
+						lua_settop(L, 2);	// p, m
+
+						return 1;
+					}
+				}, {
+					"applyOnTheRight", [](lua_State * L)
+					{
+						return NewRet<R>(L, *MatrixRef<R>{L, 2} * Getters::GetT(L)->mObject);	// p, m, mp
+					}
+				}, {
+					"applyOnTheRightInPlace", [](lua_State * L)
+					{
+						WritableMatrixRef<R> m{L, 2};
+
+						luaL_argcheck(L, m->cols() == Getters::GetT(L)->mObject.size(), 2, "Matrix column count does not match size");
+
+						*m = *m * Getters::GetT(L)->mObject;
+
+						lua_settop(L, 2);	// p, m
+
+						return 1;
+					}
+				}, {
+					"indices", [](lua_State * L)
+					{
+						return PushIndices(L, Getters::GetT(L)->mObject.indices());
+					}
+				}, {
+					"size", [](lua_State * L)
+					{
+						return LuaXS::PushArgAndReturn(L, Getters::GetT(L)->mObject.size());
+					}
+				}, {
+					"toDenseMatrix", [](lua_State * L)
+					{
+						Eigen::Index n = Getters::GetT(L)->mObject.size();
+
+						return NewRet<R>(L, Getters::GetT(L)->mObject * R::Identity(n, n));	// p, dense
+					}
+				},
+				{ nullptr, nullptr }
+			};
+
+			luaL_register(L, nullptr, methods);
+		}
+	};
+}
+
+/**********************
+* Permutation methods *
+**********************/
+template<typename U, typename R> struct AttachMethods<PermutationOf<U>, R> {
+	using Getters = InstanceGetters<PermutationOf<U>, R>;
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"compose", [](lua_State * L)
+				{
+					auto & p = Getters::GetT(L)->mObject, & q = GetInstance<PermutationOf<U>>(L, 2)->mObject;
+
+					luaL_argcheck(L, p.size() == q.size(), 2, "Permutation sizes do not match");
+
+					New<PermutationOf<U>>(L, p * q);// p, q, pq
+
+					return 1;
+				}
+			}, {
+				"determinant", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, Getters::GetT(L)->mObject.determinant());
+				}
+			}, {
+				"inverse", [](lua_State * L)
+				{
+					New<PermutationOf<U>>(L, Getters::GetT(L)->mObject.inverse());	// p, inv
+
+					return 1;
+				}
+			}, {
+				"transpose", [](lua_State * L)
+				{
+					New<PermutationOf<U>>(L, Getters::GetT(L)->mObject.transpose());// p, inv
+
+					return 1;
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+
+		detail_perm::AddCommonMethods<PermutationOf<U>, R> acm{L};
+	}
+};
+
+template<typename R> struct AuxTypeName<PermutationOf<R>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "Permutation<");
+
+		AuxTypeName<R>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
+
+/*************************
+* Transpositions methods *
+*************************/
+template<typename U, typename R> struct AttachMethods<TranspositionsOf<U>, R> {
+	using Getters = InstanceGetters<TranspositionsOf<U>, R>;
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"determinant", [](lua_State * L)
+				{
+					auto & tr = Getters::GetT(L)->mObject;
+					int det = 1;
+
+					for (Eigen::Index i = 0; i < tr.size(); ++i)
+					{
+						if (tr.coeff(i) != i) det = -det;
+					}
+
+					return LuaXS::PushArgAndReturn(L, det);
+				}
+			}, {
+				"inverse", [](lua_State * L)
+				{
+					typename PermutationOf<U>::Type p{Getters::GetT(L)->mObject};
+
+					New<PermutationOf<U>>(L, p.inverse());	// tr, inv
+
+					return 1;
+				}
+			}, {
+				"toPermutation", [](lua_State * L)
+				{
+					New<PermutationOf<U>>(L, Getters::GetT(L)->mObject);	// tr, p
+
+					return 1;
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+
+		detail_perm::AddCommonMethods<TranspositionsOf<U>, R> acm{L};
+	}
+};
+
+template<typename R> struct AuxTypeName<TranspositionsOf<R>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "Transpositions<");
+
+		AuxTypeName<R>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
+
+// Add permutation and transposition factories. Each takes a size, for the identity, or else an
+// int matrix or array of 1-based indices.
+template<typename M> struct AddPermutations {
+	AddPermutations (lua_State * L)
+	{
+		luaL_Reg funcs[] = {
+			{
+				"Permutation", [](lua_State * L)
+				{
+					New<PermutationOf<M>>(L, typename PermutationOf<M>::Type{detail_perm::GetIndices(L, 1, true)});	// indices, p
+
+					return 1;
+				}
+			}, {
+				"Transpositions", [](lua_State * L)
+				{
+					New<TranspositionsOf<M>>(L, typename TranspositionsOf<M>::Type{detail_perm::GetIndices(L, 1, false)});	// indices, tr
+
+					return 1;
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, funcs);
+	}
+};
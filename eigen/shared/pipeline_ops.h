@@ -0,0 +1,310 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+
+//
+namespace detail_pipeline {
+	// Steps that a pipeline may take. Those from eCeil to eRound, and from eClamp on, are only
+	// available to real matrices; those from eAdd on take one (or with eClamp, two) scalars.
+	enum Op {
+		eAbs, eAbs2, eAcos, eAsin, eAtan, eCos, eCosh, eCube, eExp, eInverse, eLog, eLog10, eSign, eSin, eSinh, eSqrt, eSquare, eTan, eTanh,
+		eCeil, eFloor, eRound,
+		eAdd, eDiv, eMul, ePow, eSub,
+		eClamp, eMax, eMin
+	};
+
+	// Step names, including the cwise*() aliases of the corresponding methods.
+	static const char * sNames[] = {
+		"abs", "abs2", "acos", "asin", "atan", "cos", "cosh", "cube", "exp", "inverse", "log", "log10", "sign", "sin", "sinh", "sqrt", "square", "tan", "tanh",
+		"ceil", "floor", "round",
+		"add", "div", "mul", "pow", "sub",
+		"clamp", "max", "min",
+		"cwiseAbs", "cwiseAbs2", "cwiseInverse", "cwiseMax", "cwiseMin", "cwiseSign", "cwiseSqrt",
+		nullptr
+	};
+
+	static const Op sOps[] = {
+		eAbs, eAbs2, eAcos, eAsin, eAtan, eCos, eCosh, eCube, eExp, eInverse, eLog, eLog10, eSign, eSin, eSinh, eSqrt, eSquare, eTan, eTanh,
+		eCeil, eFloor, eRound,
+		eAdd, eDiv, eMul, ePow, eSub,
+		eClamp, eMax, eMin,
+		eAbs, eAbs2, eInverse, eMax, eMin, eSign, eSqrt
+	};
+
+	template<typename S> struct Step {
+		Op mOp;	// Operation to perform
+		S mA, mB;	// Scalar arguments, if any
+	};
+
+	enum { kChunk = 256 };	// Coefficients per batch, sized to keep the batch on the stack
+
+	template<typename S> using Buffer = Eigen::Array<S, Eigen::Dynamic, 1, Eigen::ColMajor, kChunk, 1>;
+
+	// Steps only defined for real scalars.
+	template<typename S, bool = Eigen::NumTraits<S>::IsComplex> struct RealSteps {
+		static void Apply (const Step<S> & step, Buffer<S> & buf)
+		{
+			switch (step.mOp)
+			{
+			case eCeil:
+				buf = buf.ceil();
+				break;
+			case eClamp:
+				buf = buf.max(step.mA).min(step.mB);
+				break;
+			case eFloor:
+				buf = buf.floor();
+				break;
+			case eMax:
+				buf = buf.max(step.mA);
+				break;
+			case eMin:
+				buf = buf.min(step.mA);
+				break;
+			case eRound:
+				buf = buf.round();
+				break;
+			default:
+				break;
+			}
+		}
+	};
+
+	template<typename S> struct RealSteps<S, true> {
+		static void Apply (const Step<S> &, Buffer<S> &) {}	// rejected when parsed
+	};
+
+	template<typename S> void Apply (const Step<S> & step, Buffer<S> & buf)
+	{
+		switch (step.mOp)
+		{
+		case eAbs:
+			buf = buf.abs().template cast<S>();
+			break;
+		case eAbs2:
+			buf = buf.abs2().template cast<S>();
+			break;
+		case eAcos:
+			buf = buf.acos();
+			break;
+		case eAdd:
+			buf += step.mA;
+			break;
+		case eAsin:
+			buf = buf.asin();
+			break;
+		case eAtan:
+			buf = buf.atan();
+			break;
+		case eCos:
+			buf = buf.cos();
+			break;
+		case eCosh:
+			buf = buf.cosh();
+			break;
+		case eCube:
+			buf = buf.cube();
+			break;
+		case eDiv:
+			buf /= step.mA;
+			break;
+		case eExp:
+			buf = buf.exp();
+			break;
+		case eInverse:
+			buf = buf.inverse();
+			break;
+		case eLog:
+			buf = buf.log();
+			break;
+		case eLog10:
+			buf = buf.log10();
+			break;
+		case eMul:
+			buf *= step.mA;
+			break;
+		case ePow:
+			buf = buf.pow(step.mA);
+			break;
+		case eSign:
+			buf = buf.sign();
+			break;
+		case eSin:
+			buf = buf.sin();
+			break;
+		case eSinh:
+			buf = buf.sinh();
+			break;
+		case eSqrt:
+			buf = buf.sqrt();
+			break;
+		case eSquare:
+			buf = buf.square();
+			break;
+		case eSub:
+			buf -= step.mA;
+			break;
+		case eTan:
+			buf = buf.tan();
+			break;
+		case eTanh:
+			buf = buf.tanh();
+			break;
+		default:
+			RealSteps<S>::Apply(step, buf);
+		}
+	}
+
+	// Read the steps, each being either a name or a table with a name and scalar arguments.
+	template<typename R> std::vector<Step<typename R::Scalar>> Parse (lua_State * L, int arg)
+	{
+		using S = typename R::Scalar;
+
+		luaL_checktype(L, arg, LUA_TTABLE);
+
+		std::vector<Step<S>> steps;
+
+		for (size_t i = 1, n = lua_objlen(L, arg); i <= n; ++i, lua_pop(L, 1))
+		{
+			lua_rawgeti(L, arg, int(i));// ..., step
+
+			int top = lua_gettop(L), name = top;
+
+			if (lua_istable(L, top))
+			{
+				lua_rawgeti(L, top, 1);	// ..., step, name
+				lua_rawgeti(L, top, 2);	// ..., step, name, a
+				lua_rawgeti(L, top, 3);	// ..., step, name, a, b
+
+				name = top + 1;
+			}
+
+			Step<S> step{};
+
+			step.mOp = sOps[luaL_checkoption(L, name, nullptr, sNames)];
+
+			if (Eigen::NumTraits<S>::IsComplex && ((step.mOp >= eCeil && step.mOp <= eRound) || step.mOp >= eClamp)) luaL_error(L, "Step %s requires a real matrix", lua_tostring(L, name));
+
+			if (step.mOp >= eAdd)
+			{
+				luaL_argcheck(L, name != top, arg, "Step with arguments must be a table");
+
+				step.mA = AsScalar<R>(L, top + 2);
+
+				if (step.mOp == eClamp) step.mB = AsScalar<R>(L, top + 3);
+			}
+
+			steps.push_back(step);
+
+			lua_settop(L, top);	// ..., step
+		}
+
+		return steps;
+	}
+
+	// Run the steps over a vector's coefficients, a batch at a time, with no intermediates.
+	template<typename S, typename In, typename Out> void Run (const std::vector<Step<S>> & steps, const In & in, Out && out)
+	{
+		Buffer<S> buf;
+
+		for (Eigen::Index i = 0, n = in.size(); i < n; i += kChunk)
+		{
+			Eigen::Index count = (std::min)(Eigen::Index(kChunk), n - i);
+
+			buf = in.segment(i, count).array();
+
+			for (auto & step : steps) Apply(step, buf);
+
+			out.segment(i, count) = buf.matrix();
+		}
+	}
+
+	// Apply a fused sequence of coefficient-wise steps: mat, steps[, out]. Results are written to
+	// the output, if provided (this may be mat itself); otherwise to a new matrix.
+	template<typename R> static int Pipeline (lua_State * L)
+	{
+		using S = typename R::Scalar;
+
+		auto steps = Parse<R>(L, 2);
+		MatrixRef<R> mat{L, 1};
+		WritableMatrixRef<R> out;
+
+		if (lua_isuserdata(L, 3))
+		{
+			out.Init(L, 3);
+
+			luaL_argcheck(L, out->rows() == mat->rows() && out->cols() == mat->cols(), 3, "Output dimensions do not match matrix");
+
+			lua_settop(L, 3);	// mat, steps, out
+		}
+
+		else
+		{
+			New<R>(L, mat->rows(), mat->cols());// mat, steps[, nil], out
+
+			out.Init(L, lua_gettop(L));
+		}
+
+		// With contiguous storage, the matrices are processed as single vectors.
+		if (mat->outerStride() == mat->rows() && out->outerStride() == out->rows())
+		{
+			Eigen::Map<const ColVector<S>> from{mat->data(), mat->size()};
+			Eigen::Map<ColVector<S>> to{out->data(), out->size()};
+
+			Run(steps, from, to);
+		}
+
+		else
+		{
+			for (Eigen::Index j = 0; j < mat->cols(); ++j) Run(steps, mat->col(j), out->col(j));
+		}
+
+		return 1;
+	}
+}
+
+// Methods assigned to matrices with non-integer types.
+template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsInteger> struct PipelineOps {
+	PipelineOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"pipeline", detail_pipeline::Pipeline<R>
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// No-op for integer types.
+template<typename T, typename R> struct PipelineOps<T, R, false> {
+	PipelineOps (lua_State *) {}
+};
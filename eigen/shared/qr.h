@@ -24,6 +24,7 @@
 #pragma once
 
 #include "solver_base.h"
+#include "permutation.h"
 
 //
 template<typename U, typename R> struct QRMethodsBase : SolverMethodsBase<U, R> {
@@ -87,7 +88,7 @@ template<typename U, typename R> struct AttachMethods<Eigen::ColPivHouseholderQR
 	{
 		luaL_Reg methods[] = {
 			{
-				EIGEN_MATRIX_GET_MATRIX_METHOD(colsPermutation)
+				EIGEN_PERMUTATION_METHOD(colsPermutation, PermutationOf)
 			}, {
 				EIGEN_MATRIX_GET_MATRIX_METHOD(inverse)
 			}, {
@@ -153,6 +154,13 @@ template<typename U, typename R> struct AttachMethods<Eigen::FullPivHouseholderQ
 			}, {
 				"rowsTranspositions", [](lua_State * L)
 				{
+					if (WantsBool(L, "Native", 2))
+					{
+						New<TranspositionsOf<R>>(L, Getters::GetT(L)->rowsTranspositions().template cast<int>());	// qr, how, tr
+
+						return 1;
+					}
+
 					auto td = TypeData<Eigen::MatrixXi>::Get(L);
 
 					luaL_argcheck(L, td, 2, "rowsTranspositions() requires int matrices");
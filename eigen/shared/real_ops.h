@@ -28,6 +28,7 @@
 #include "types.h"
 #include "utils.h"
 #include "macros.h"
+#include "bit_matrix.h"
 
 // Version of methods when we have a matrix or basic map.
 template<typename T, typename R, bool = HasNormalStride<T>::value> struct AddIfNormalStride {
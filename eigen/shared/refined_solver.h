@@ -0,0 +1,182 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "solver_base.h"
+
+// Solver that factors a matrix in single precision, then recovers full accuracy by iterative
+// refinement, with residuals computed in the matrix's own (double) precision. Factoring is
+// the O(n^3) step, so it runs at float speed, whereas refinement costs only O(n^2) per step.
+template<typename R> struct RefinedSolver {
+	using Scalar = typename R::Scalar;
+	using Real = typename Eigen::NumTraits<Scalar>::Real;
+	using LowScalar = typename std::conditional<Eigen::NumTraits<Scalar>::IsComplex, std::complex<float>, float>::type;
+	using LowMatrix = MatrixOf<LowScalar>;
+
+	enum Method { ePartialPivLU, eLLT };
+
+	Eigen::PartialPivLU<LowMatrix> mLU;	// Low-precision factorizations; only the one chosen is computed
+	Eigen::LLT<LowMatrix> mLLT;
+	R mMatrix;	// Original matrix, used to form residuals
+	Real mMatrixNorm;	// Its infinity norm
+	Real mTolerance;// Scale of the acceptable residual
+	Method mMethod;	// Which factorization is in use?
+	Eigen::ComputationInfo mInfo{Eigen::Success};	// Outcome of the most recent step
+	int mMaxIterations{30};	// Refinement step limit
+	int mIterations{0};	// Steps taken by the most recent solve
+
+	RefinedSolver (const R & m, Method method) : mMatrix{m}, mMethod{method}
+	{
+		LowMatrix low = m.template cast<LowScalar>();
+
+		if (method == eLLT)
+		{
+			mLLT.compute(low);
+
+			if (mLLT.info() != Eigen::Success) mInfo = Eigen::NumericalIssue;
+		}
+
+		else mLU.compute(low);
+
+		mMatrixNorm = m.cwiseAbs().rowwise().sum().maxCoeff();
+		mTolerance = Eigen::NumTraits<Real>::epsilon() * std::sqrt(Real(m.cols()));
+	}
+
+	R LowSolve (const R & b) const
+	{
+		if (mMethod == eLLT) return mLLT.solve(b.template cast<LowScalar>()).template cast<Scalar>();
+		else return mLU.solve(b.template cast<LowScalar>()).template cast<Scalar>();
+	}
+
+	// Solve A * x = b, refining until the residual is small relative to A and x. This follows
+	// LAPACK's dsgesv, i.e. |r| <= |x| * |A| * tolerance, with infinity norms throughout.
+	R solve (const R & b)
+	{
+		mIterations = 0;
+
+		if (mMethod == eLLT && mLLT.info() != Eigen::Success)
+		{
+			mInfo = Eigen::NumericalIssue;
+
+			return R::Zero(mMatrix.cols(), b.cols());
+		}
+
+		R x = LowSolve(b);
+
+		for (;;)
+		{
+			if (!x.allFinite())
+			{
+				mInfo = Eigen::NumericalIssue;
+
+				break;
+			}
+
+			R r = b - mMatrix * x;
+
+			if (r.cwiseAbs().maxCoeff() <= x.cwiseAbs().maxCoeff() * mMatrixNorm * mTolerance)
+			{
+				mInfo = Eigen::Success;
+
+				break;
+			}
+
+			else if (mIterations == mMaxIterations)
+			{
+				mInfo = Eigen::NoConvergence;
+
+				break;
+			}
+
+			x += LowSolve(r);
+
+			++mIterations;
+		}
+
+		return x;
+	}
+
+	Eigen::ComputationInfo info (void) const { return mInfo; }
+	int iterations (void) const { return mIterations; }
+	int maxIterations (void) const { return mMaxIterations; }
+	Real tolerance (void) const { return mTolerance; }
+
+	void setMaxIterations (int count) { mMaxIterations = count; }
+	void setTolerance (Real tolerance) { mTolerance = tolerance; }
+};
+
+/************************
+* RefinedSolver methods *
+************************/
+template<typename U, typename R> struct AttachMethods<RefinedSolver<U>, R> : SolverMethodsBase<RefinedSolver<U>, R> {
+	using Getters = InstanceGetters<RefinedSolver<U>, R>;
+	using Real = typename RefinedSolver<U>::Real;
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"info", SolverMethodsBase<RefinedSolver<U>, R>::template Info<>
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(iterations)
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(maxIterations)
+			}, {
+				"setMaxIterations", SolverMethodsBase<RefinedSolver<U>, R>::template SetMaxIterations<>
+			}, {
+				"setTolerance", [](lua_State * L)
+				{
+					Getters::GetT(L)->setTolerance(LuaXS::GetArg<Real>(L, 2));
+
+					return SelfForChaining(L);	// solver, tolerance, solver
+				}
+			}, {
+				"solve", [](lua_State * L)
+				{
+					RefinedSolver<U> & solver = *Getters::GetT(L);
+
+					New<R>(L, solver.solve(Getters::GetR(L, 2)));	// solver, b, x
+
+					return 1 + LuaXS::PushArgAndReturn(L, solver.iterations());	// solver, b, x, iterations
+				}
+			}, {
+				EIGEN_MATRIX_PUSH_VALUE_METHOD(tolerance)
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+template<typename T> struct AuxTypeName<RefinedSolver<T>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "RefinedSolver<");
+
+		AuxTypeName<T>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
@@ -0,0 +1,263 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+
+// Runtime selection among kernels built for several instruction sets. Eigen itself is fixed to
+// whatever the build's flags allow, e.g. SSE2 on most x86 toolchains, so a few hot loops are
+// compiled again for AVX2 and AVX-512 (with GCC or Clang, via per-function target options)
+// and chosen once, on first use, according to what the CPU reports. Elsewhere, the baseline
+// build is used, which on ARM already includes NEON.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#define EIGEN_PLUGIN_SIMD_DISPATCH
+#endif
+
+namespace detail_simd {
+	enum Level { eScalar, eSSE2, eNEON, eAVX2, eAVX512 };
+
+	namespace base {
+		#include "simd_kernels.h"
+	}
+
+#ifdef EIGEN_PLUGIN_SIMD_DISPATCH
+	#ifdef __clang__
+		#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+	#else
+		#pragma GCC push_options
+		#pragma GCC target("avx2,fma")
+	#endif
+
+	namespace avx2 {
+		#include "simd_kernels.h"
+	}
+
+	#ifdef __clang__
+		#pragma clang attribute pop
+		#pragma clang attribute push (__attribute__((target("avx512f,avx512dq,avx2,fma"))), apply_to = function)
+	#else
+		#pragma GCC pop_options
+		#pragma GCC push_options
+		#pragma GCC target("avx512f,avx512dq,avx2,fma")
+	#endif
+
+	namespace avx512 {
+		#include "simd_kernels.h"
+	}
+
+	#ifdef __clang__
+		#pragma clang attribute pop
+	#else
+		#pragma GCC pop_options
+	#endif
+#endif
+
+	// Level of the baseline build.
+	inline Level BuildLevel (void)
+	{
+	#if defined(__AVX512F__)
+		return eAVX512;
+	#elif defined(__AVX2__)
+		return eAVX2;
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		return eSSE2;
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		return eNEON;
+	#else
+		return eScalar;
+	#endif
+	}
+
+	// Best level available on this CPU, detected once.
+	inline Level GetLevel (void)
+	{
+		static const Level sLevel = []() {
+			Level level = BuildLevel();
+
+		#ifdef EIGEN_PLUGIN_SIMD_DISPATCH
+			__builtin_cpu_init();
+
+			if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) level = eAVX512;
+			else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && level < eAVX2) level = eAVX2;
+		#endif
+
+			return level;
+		}();
+
+		return sLevel;
+	}
+
+	inline const char * LevelName (Level level)
+	{
+		const char * names[] = { "scalar", "sse2", "neon", "avx2", "avx512" };
+
+		return names[level];
+	}
+
+	// Kernels for a given scalar type, at the detected level.
+	template<typename S> struct Kernels {
+		S (*mDot)(const S *, const S *, Eigen::Index);
+		S (*mSum)(const S *, Eigen::Index);
+		S (*mSquaredSum)(const S *, Eigen::Index);
+		void (*mAddScaled)(S *, const S *, const S *, S, Eigen::Index);
+		void (*mProduct)(S *, const S *, const S *, Eigen::Index);
+		void (*mTransformRows)(const S * const [3], S * const [3], Eigen::Index, const S *, const S *, bool, bool);
+	};
+
+	#define EIGEN_SIMD_KERNEL_TABLE(NS) Kernels<S>{ NS::Dot<S>, NS::Sum<S>, NS::SquaredSum<S>, NS::AddScaled<S>, NS::Product<S>, NS::TransformRows<S> }
+
+	template<typename S> const Kernels<S> & Get (void)
+	{
+		static const Kernels<S> sKernels = []() {
+			switch (GetLevel())
+			{
+		#ifdef EIGEN_PLUGIN_SIMD_DISPATCH
+			case eAVX512:
+				return EIGEN_SIMD_KERNEL_TABLE(avx512);
+			case eAVX2:
+				return EIGEN_SIMD_KERNEL_TABLE(avx2);
+		#endif
+			default:
+				return EIGEN_SIMD_KERNEL_TABLE(base);
+			}
+		}();
+
+		return sKernels;
+	}
+
+	#undef EIGEN_SIMD_KERNEL_TABLE
+
+	// Only real single and double precision go through the kernels.
+	template<typename S> struct IsDispatched : std::integral_constant<bool, std::is_same<S, float>::value || std::is_same<S, double>::value> {};
+
+	// Sum or difference of two matrices, via the kernels if both are plain and the same shape.
+	template<typename T, typename R, bool = std::is_same<T, R>::value && IsDispatched<typename R::Scalar>::value> struct Arith {
+		static int Add (lua_State * L, const T & a, const T & b) { return NewRet<R>(L, a + b); }
+		static int Sub (lua_State * L, const T & a, const T & b) { return NewRet<R>(L, a - b); }
+	};
+
+	template<typename T, typename R> struct Arith<T, R, true> {
+		using Scalar = typename R::Scalar;
+
+		static int Combine (lua_State * L, const R & a, const R & b, Scalar scale)
+		{
+			R & out = *New<R>(L, a.rows(), a.cols());	// a, b, out
+
+			Get<Scalar>().mAddScaled(out.data(), a.data(), b.data(), scale, a.size());
+
+			return 1;
+		}
+
+		static int Add (lua_State * L, const R & a, const R & b)
+		{
+			if (a.rows() != b.rows() || a.cols() != b.cols()) return NewRet<R>(L, a + b);	// let Eigen report the mismatch
+			else return Combine(L, a, b, Scalar(1));
+		}
+
+		static int Sub (lua_State * L, const R & a, const R & b)
+		{
+			if (a.rows() != b.rows() || a.cols() != b.cols()) return NewRet<R>(L, a - b);
+			else return Combine(L, a, b, Scalar(-1));
+		}
+	};
+}
+
+// Methods that replace their generic versions for plain real matrices, routing them through the
+// dispatched kernels. Other argument shapes fall back to the usual Eigen code.
+template<typename T, typename R, bool = std::is_same<T, R>::value && detail_simd::IsDispatched<typename T::Scalar>::value> struct SimdOps {
+	using Getters = InstanceGetters<T, R>;
+	using Scalar = typename R::Scalar;
+
+	static bool SameShape (const R & a, const R & b) { return a.rows() == b.rows() && a.cols() == b.cols(); }
+
+	SimdOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"cwiseProduct", [](lua_State * L)
+				{
+					const R & a = *Getters::GetT(L);
+
+					if (HasType<R>(L, 2) && SameShape(a, *LuaXS::UD<R>(L, 2)))
+					{
+						const R & b = *LuaXS::UD<R>(L, 2);
+						R & out = *New<R>(L, a.rows(), a.cols());	// a, b, out
+
+						detail_simd::Get<Scalar>().mProduct(out.data(), a.data(), b.data(), a.size());
+
+						return 1;
+					}
+
+					EIGEN_MATRIX_GET_MATRIX_MATRIX_PAIR(cwiseProduct);
+				}
+			}, {
+				"dot", [](lua_State * L)
+				{
+					const R & a = *Getters::GetT(L);
+
+					if (HasType<R>(L, 2))
+					{
+						const R & b = *LuaXS::UD<R>(L, 2);
+
+						if ((a.rows() == 1 || a.cols() == 1) && (b.rows() == 1 || b.cols() == 1) && a.size() == b.size()) return LuaXS::PushArgAndReturn(L, detail_simd::Get<Scalar>().mDot(a.data(), b.data(), a.size()));
+					}
+
+					return LuaXS::PushArgAndReturn(L, ColumnVector<R>{L}->dot(*ColumnVector<R>{L, 2}));
+				}
+			}, {
+				"norm", [](lua_State * L)
+				{
+					const R & a = *Getters::GetT(L);
+
+					return LuaXS::PushArgAndReturn(L, std::sqrt(detail_simd::Get<Scalar>().mSquaredSum(a.data(), a.size())));
+				}
+			}, {
+				"squaredNorm", [](lua_State * L)
+				{
+					const R & a = *Getters::GetT(L);
+
+					return LuaXS::PushArgAndReturn(L, detail_simd::Get<Scalar>().mSquaredSum(a.data(), a.size()));
+				}
+			}, {
+				"sum", [](lua_State * L)
+				{
+					const R & a = *Getters::GetT(L);
+
+					return LuaXS::PushArgAndReturn(L, detail_simd::Get<Scalar>().mSum(a.data(), a.size()));
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// No-op for other types, and for maps, blocks, etc.
+template<typename T, typename R> struct SimdOps<T, R, false> {
+	SimdOps (lua_State *) {}
+};
@@ -0,0 +1,106 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+// No include guard: simd_dispatch.h includes this once per instruction set, each time inside its
+// own namespace and with the matching target options in effect. The loops are written to be
+// auto-vectorized at whatever width that target offers. Reductions spread across independent
+// lanes, since the compiler may not reorder floating point sums itself.
+
+enum { kLanes = 16 };
+
+template<typename S> S Dot (const S * EIGEN_RESTRICT a, const S * EIGEN_RESTRICT b, Eigen::Index n)
+{
+	S acc[kLanes] = {}, sum = 0;
+	Eigen::Index i = 0;
+
+	for (; i + kLanes <= n; i += kLanes)
+	{
+		for (int j = 0; j < kLanes; ++j) acc[j] += a[i + j] * b[i + j];
+	}
+
+	for (; i < n; ++i) sum += a[i] * b[i];
+	for (int j = 0; j < kLanes; ++j) sum += acc[j];
+
+	return sum;
+}
+
+template<typename S> S Sum (const S * EIGEN_RESTRICT a, Eigen::Index n)
+{
+	S acc[kLanes] = {}, sum = 0;
+	Eigen::Index i = 0;
+
+	for (; i + kLanes <= n; i += kLanes)
+	{
+		for (int j = 0; j < kLanes; ++j) acc[j] += a[i + j];
+	}
+
+	for (; i < n; ++i) sum += a[i];
+	for (int j = 0; j < kLanes; ++j) sum += acc[j];
+
+	return sum;
+}
+
+template<typename S> S SquaredSum (const S * EIGEN_RESTRICT a, Eigen::Index n)
+{
+	return Dot(a, a, n);
+}
+
+// out = a + scale * b
+template<typename S> void AddScaled (S * EIGEN_RESTRICT out, const S * EIGEN_RESTRICT a, const S * EIGEN_RESTRICT b, S scale, Eigen::Index n)
+{
+	for (Eigen::Index i = 0; i < n; ++i) out[i] = a[i] + scale * b[i];
+}
+
+// out = a * b, coefficient-wise
+template<typename S> void Product (S * EIGEN_RESTRICT out, const S * EIGEN_RESTRICT a, const S * EIGEN_RESTRICT b, Eigen::Index n)
+{
+	for (Eigen::Index i = 0; i < n; ++i) out[i] = a[i] * b[i];
+}
+
+// Transform n points whose coordinates are in separate arrays, by a column-major 3x3 matrix and,
+// if affine, an offset. The output arrays may be the input ones.
+template<typename S> void TransformRows (const S * const in[3], S * const out[3], Eigen::Index n, const S * m, const S * t, bool bAffine, bool bNormalize)
+{
+	const S t0 = bAffine ? t[0] : S(0), t1 = bAffine ? t[1] : S(0), t2 = bAffine ? t[2] : S(0);
+	const S * x = in[0], * y = in[1], * z = in[2];
+	S * ox = out[0], * oy = out[1], * oz = out[2];
+
+	for (Eigen::Index i = 0; i < n; ++i)
+	{
+		S px = x[i], py = y[i], pz = z[i];
+		S rx = m[0] * px + m[3] * py + m[6] * pz + t0;
+		S ry = m[1] * px + m[4] * py + m[7] * pz + t1;
+		S rz = m[2] * px + m[5] * py + m[8] * pz + t2;
+
+		if (bNormalize)
+		{
+			S len = std::sqrt(rx * rx + ry * ry + rz * rz);
+
+			if (len > S(0)) rx /= len, ry /= len, rz /= len;
+		}
+
+		ox[i] = rx;
+		oy[i] = ry;
+		oz[i] = rz;
+	}
+}
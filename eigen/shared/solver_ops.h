@@ -44,6 +44,15 @@ template<typename T, typename R, bool = Eigen::NumTraits<typename T::Scalar>::Is
                         NewRvalue<Eigen::ComplexEigenSolver<R>>(L, ref, !WantsBool(L, "NoEigenvectors"));
                     });
                 }
+            }, {
+                "eigenSolverAsync", [](lua_State * L)
+                {
+                    bool bVectors = !WantsBool(L, "NoEigenvectors");
+
+                    return LaunchAsync<Eigen::ComplexEigenSolver<R>, T, R>(L, [bVectors](const R & a, const R &) {
+                        return new Eigen::ComplexEigenSolver<R>{a, bVectors};
+                    }, eSquare);
+                }
             }, {
                 "schur", [](lua_State * L)
                 {
@@ -51,6 +60,15 @@ template<typename T, typename R, bool = Eigen::NumTraits<typename T::Scalar>::Is
                         NewRvalue<Eigen::ComplexSchur<R>>(L, ref, !WantsBool(L, "NoU"));
                     });
                 }
+            }, {
+                "schurAsync", [](lua_State * L)
+                {
+                    bool bU = !WantsBool(L, "NoU");
+
+                    return LaunchAsync<Eigen::ComplexSchur<R>, T, R>(L, [bU](const R & a, const R &) {
+                        return new Eigen::ComplexSchur<R>{a, bU};
+                    }, eSquare);
+                }
             },
             { nullptr, nullptr }
         };
@@ -74,6 +92,15 @@ template<typename T, typename R> struct IgnoreWhenComplex<T, R, false> {
                         NewRvalue<Eigen::EigenSolver<R>>(L, ref, !WantsBool(L, "NoEigenvectors"));
                     });
                 }
+            }, {
+                "eigenSolverAsync", [](lua_State * L)
+                {
+                    bool bVectors = !WantsBool(L, "NoEigenvectors");
+
+                    return LaunchAsync<Eigen::EigenSolver<R>, T, R>(L, [bVectors](const R & a, const R &) {
+                        return new Eigen::EigenSolver<R>{a, bVectors};
+                    }, eSquare);
+                }
             }, {
                 "generalizedEigenSolver", [](lua_State * L)
                 {
@@ -81,6 +108,15 @@ template<typename T, typename R> struct IgnoreWhenComplex<T, R, false> {
                         NewRvalue<Eigen::GeneralizedEigenSolver<R>>(L, ref, Getters::GetR(L, 2), !WantsBool(L, "NoEigenvectors"));
                     });
                 }
+            }, {
+                "generalizedEigenSolverAsync", [](lua_State * L)
+                {
+                    bool bVectors = !WantsBool(L, "NoEigenvectors");
+
+                    return LaunchAsync<Eigen::GeneralizedEigenSolver<R>, T, R>(L, [bVectors](const R & a, const R & b) {
+                        return new Eigen::GeneralizedEigenSolver<R>{a, b, bVectors};
+                    }, eSquarePair);
+                }
             }, {
                 "realQz", [](lua_State * L)
                 {
@@ -88,6 +124,15 @@ template<typename T, typename R> struct IgnoreWhenComplex<T, R, false> {
                         NewRvalue<Eigen::RealQZ<R>>(L, ref, Getters::GetR(L, 2), !WantsBool(L, "NoQZ"));
                     });
                 }
+            }, {
+                "realQzAsync", [](lua_State * L)
+                {
+                    bool bQZ = !WantsBool(L, "NoQZ");
+
+                    return LaunchAsync<Eigen::RealQZ<R>, T, R>(L, [bQZ](const R & a, const R & b) {
+                        return new Eigen::RealQZ<R>{a, b, bQZ};
+                    }, eSquarePair);
+                }
             }, {
                 "schur", [](lua_State * L)
                 {
@@ -95,6 +140,15 @@ template<typename T, typename R> struct IgnoreWhenComplex<T, R, false> {
                         NewRvalue<Eigen::RealSchur<R>>(L, ref, !WantsBool(L, "NoU"));
                     });
                 }
+            }, {
+                "schurAsync", [](lua_State * L)
+                {
+                    bool bU = !WantsBool(L, "NoU");
+
+                    return LaunchAsync<Eigen::RealSchur<R>, T, R>(L, [bU](const R & a, const R &) {
+                        return new Eigen::RealSchur<R>{a, bU};
+                    }, eSquare);
+                }
             },
             { nullptr, nullptr }
         };
@@ -103,6 +157,38 @@ template<typename T, typename R> struct IgnoreWhenComplex<T, R, false> {
     }
 };
 
+// Add a mixed-precision solver for double-based types, which factors in single precision.
+template<typename T, typename R, bool = std::is_same<typename Eigen::NumTraits<typename T::Scalar>::Real, double>::value> struct AddRefinedSolver {
+    using Getters = InstanceGetters<T, R>;
+
+    AddRefinedSolver (lua_State * L)
+    {
+        luaL_Reg methods[] = {
+            {
+                "refinedSolver", [](lua_State * L)
+                {
+                    const char * names[] = { "partialPivLu", "llt", nullptr };
+                    typename RefinedSolver<R>::Method methods[] = { RefinedSolver<R>::ePartialPivLU, RefinedSolver<R>::eLLT };
+                    auto method = methods[luaL_checkoption(L, 2, "partialPivLu", names)];
+
+                    return Getters::WithRef(L, [L, method](const R & ref) {
+                        NewRvalue<RefinedSolver<R>>(L, ref, method);	// mat[, how], solver
+                    });
+                }
+            },
+            { nullptr, nullptr }
+        };
+
+        luaL_register(L, nullptr, methods);
+    }
+};
+
+template<typename T, typename R> struct AddRefinedSolver<T, R, false> {
+    AddRefinedSolver (lua_State *) {}
+};
+
+template<typename T, typename R> struct AddAsyncSolvers;
+
 // Methods assigned to matrices with non-integer types.
 template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsInteger> struct SolverOps {
     using Getters = InstanceGetters<T, R>;
@@ -124,6 +210,32 @@ template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::I
 		return opts;
 	}
 
+	// Helper to supply options to generalized self-adjoint eigensolvers, from the table (if any)
+	// at index 3.
+	static int GetGeneralizedOpts (lua_State * L)
+	{
+		auto compute = Eigen::ComputeEigenvectors;
+		auto method = Eigen::Ax_lBx;
+
+		if (lua_istable(L, 3))
+		{
+			lua_getfield(L, 3, "no_eigenvectors");	// a, b, opts, no_eigenvectors?
+
+			if (lua_toboolean(L, -1)) compute = Eigen::EigenvaluesOnly;
+
+			lua_getfield(L, 3, "method");	// a, b, opts, no_eigenvectors?, method?
+
+			const char * names[] = { "ABx_lx", "Ax_lBx", "BAx_lx", nullptr };
+			decltype(method) methods[] = { Eigen::ABx_lx, Eigen::Ax_lBx, Eigen::BAx_lx };
+
+			method = methods[luaL_checkoption(L, -1, "Ax_lBx", names)];
+
+			lua_pop(L, 2);	// a, b, opts
+		}
+
+		return compute | method;
+	}
+
 	SolverOps (lua_State * L)
 	{
         typedef typename Getters::RefType RefType; // Visual Studio workaround
@@ -169,25 +281,10 @@ template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::I
 			}, {
 				"generalizedSelfAdjointEigenSolver", [](lua_State * L)
 				{
-					return Getters::WithRef(L, [L](const RefType & ref) {
-						auto compute = Eigen::ComputeEigenvectors;
-						auto method = Eigen::Ax_lBx;
-
-						if (lua_istable(L, 3))
-						{
-							lua_getfield(L, 3, "no_eigenvectors");	// a, b, opts, no_eigenvectors?
-
-							if (lua_toboolean(L, -1)) compute = Eigen::EigenvaluesOnly;
-
-							lua_getfield(L, 3, "method");	// a, b, opts, no_eigenvectors?, method
-
-							const char * names[] = { "ABx_lx", "Ax_lBx", "BAx_lx", nullptr };
-							decltype(method) methods[] = { Eigen::Ax_lBx, Eigen::Ax_lBx, Eigen::BAx_lx };
-
-							method = methods[luaL_checkoption(L, -1, "", names)];
-						}
+					int opts = GetGeneralizedOpts(L);
 
-                        NewRvalue<Eigen::GeneralizedSelfAdjointEigenSolver<R>>(L, ref, Getters::GetR(L, 2), compute | method);
+					return Getters::WithRef(L, [L, opts](const RefType & ref) {
+                        NewRvalue<Eigen::GeneralizedSelfAdjointEigenSolver<R>>(L, ref, Getters::GetR(L, 2), opts);
 					});
 				}
 			}, {
@@ -206,6 +303,19 @@ template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::I
 				}
 			}, {
 				EIGEN_MATRIX_GET_MATRIX_METHOD(inverse)
+			}, {
+				"iterativeSolver", [](lua_State * L)
+				{
+					const char * names[] = { "conjugateGradient", "bicgstab", nullptr };
+					typename IterativeSolver<R>::Method methods[] = { IterativeSolver<R>::eConjugateGradient, IterativeSolver<R>::eBiCGSTAB };
+					auto method = methods[luaL_checkoption(L, 2, "bicgstab", names)];
+
+					return Getters::WithRef(L, [L, method](const RefType & ref) {
+						luaL_argcheck(L, ref.rows() == ref.cols(), 1, "iterativeSolver() requires a square matrix");
+
+						NewRvalue<IterativeSolver<R>>(L, ref, method);	// mat[, how], solver
+					});
+				}
 			}, {
 				"jacobiSvd", [](lua_State * L)
 				{
@@ -291,9 +401,196 @@ template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::I
 		lua_setfield(L, -2, "lu");	// methods = { lu = pplu }
 
         IgnoreWhenComplex<T, R> iwc{L};
+        AddRefinedSolver<T, R> ars{L};
+        AddAsyncSolvers<T, R> aas{L};
 	}
 };
 
+// Background-thread variants of the factories, which return AsyncDecomposition handles. Options
+// are read up front, while on the Lua thread.
+template<typename T, typename R> struct AddAsyncSolvers {
+    // Check SVD options that the decomposition would otherwise assert against on the worker.
+    static unsigned int CheckSvdOpts (lua_State * L, unsigned int opts, bool bThinOK = true)
+    {
+        luaL_argcheck(L, (opts & (Eigen::ComputeFullU | Eigen::ComputeThinU)) != (Eigen::ComputeFullU | Eigen::ComputeThinU), 2, "Cannot compute both full and thin U");
+        luaL_argcheck(L, (opts & (Eigen::ComputeFullV | Eigen::ComputeThinV)) != (Eigen::ComputeFullV | Eigen::ComputeThinV), 2, "Cannot compute both full and thin V");
+        luaL_argcheck(L, bThinOK || !(opts & (Eigen::ComputeThinU | Eigen::ComputeThinV)), 2, "Thin U and V are unavailable with this preconditioner");
+
+        return opts;
+    }
+
+    AddAsyncSolvers (lua_State * L)
+    {
+        luaL_Reg methods[] = {
+            {
+                "bdcSvdAsync", [](lua_State * L)
+                {
+                    unsigned int opts = CheckSvdOpts(L, lua_istable(L, 2) ? SolverOps<T, R>::GetOpts(L) : 0U);
+
+                    return LaunchAsync<Eigen::BDCSVD<R>, T, R>(L, [opts](const R & a, const R &) {
+                        return new Eigen::BDCSVD<R>{a, opts};
+                    });
+                }
+            }, {
+                "colPivHouseholderQrAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::ColPivHouseholderQR<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::ColPivHouseholderQR<R>{a};
+                    });
+                }
+            }, {
+                "completeOrthogonalDecompositionAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::CompleteOrthogonalDecomposition<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::CompleteOrthogonalDecomposition<R>{a};
+                    });
+                }
+            }, {
+                "fullPivHouseholderQrAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::FullPivHouseholderQR<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::FullPivHouseholderQR<R>{a};
+                    });
+                }
+            }, {
+                "fullPivLuAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::FullPivLU<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::FullPivLU<R>{a};
+                    });
+                }
+            }, {
+                "generalizedSelfAdjointEigenSolverAsync", [](lua_State * L)
+                {
+                    int opts = SolverOps<T, R>::GetGeneralizedOpts(L);
+
+                    return LaunchAsync<Eigen::GeneralizedSelfAdjointEigenSolver<R>, T, R>(L, [opts](const R & a, const R & b) {
+                        return new Eigen::GeneralizedSelfAdjointEigenSolver<R>{a, b, opts};
+                    }, eSquarePair);
+                }
+            }, {
+                "hessenbergDecompositionAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::HessenbergDecomposition<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::HessenbergDecomposition<R>{a};
+                    }, eSquare);
+                }
+            }, {
+                "householderQrAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::HouseholderQR<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::HouseholderQR<R>{a};
+                    });
+                }
+            }, {
+                "jacobiSvdAsync", [](lua_State * L)
+                {
+                    unsigned int opts = 0U;
+
+                    if (lua_istable(L, 2))
+                    {
+                        opts = SolverOps<T, R>::GetOpts(L);
+
+                        lua_getfield(L, 2, "preconditioner");	// mat, opts, precond
+                        lua_replace(L, 2);	// mat, precond
+                    }
+
+                    const char * choices[] = { "", "fullPiv", "householder", "none", nullptr };
+                    int choice = luaL_checkoption(L, 2, "", choices);
+
+                    CheckSvdOpts(L, opts, choice != 1);
+
+                    switch (choice)
+                    {
+                    case 0:
+                        return LaunchAsync<Eigen::JacobiSVD<R>, T, R>(L, [opts](const R & a, const R &) {
+                            return new Eigen::JacobiSVD<R>{a, opts};
+                        });
+                    case 1:
+                        return LaunchAsync<Eigen::JacobiSVD<R, Eigen::FullPivHouseholderQRPreconditioner>, T, R>(L, [opts](const R & a, const R &) {
+                            return new Eigen::JacobiSVD<R, Eigen::FullPivHouseholderQRPreconditioner>{a, opts};
+                        });
+                    case 2:
+                        return LaunchAsync<Eigen::JacobiSVD<R, Eigen::HouseholderQRPreconditioner>, T, R>(L, [opts](const R & a, const R &) {
+                            return new Eigen::JacobiSVD<R, Eigen::HouseholderQRPreconditioner>{a, opts};
+                        });
+                    default: // luaL_checkoption will catch anything else
+                        return LaunchAsync<Eigen::JacobiSVD<R, Eigen::NoQRPreconditioner>, T, R>(L, [opts](const R & a, const R &) {
+                            return new Eigen::JacobiSVD<R, Eigen::NoQRPreconditioner>{a, opts};
+                        });
+                    }
+                }
+            }, {
+                "ldltAsync", [](lua_State * L)
+                {
+                    lua_settop(L, 2);	// mat, how?
+
+                    if (!WantsBool(L, "upper", 2))
+                    {
+                        return LaunchAsync<Eigen::LDLT<R, Eigen::Lower>, T, R>(L, [](const R & a, const R &) {
+                            return new Eigen::LDLT<R, Eigen::Lower>{a};
+                        }, eSquare);
+                    }
+
+                    else
+                    {
+                        return LaunchAsync<Eigen::LDLT<R, Eigen::Upper>, T, R>(L, [](const R & a, const R &) {
+                            return new Eigen::LDLT<R, Eigen::Upper>{a};
+                        }, eSquare);
+                    }
+                }
+            }, {
+                "lltAsync", [](lua_State * L)
+                {
+                    lua_settop(L, 2);	// mat, how?
+
+                    if (!WantsBool(L, "upper", 2))
+                    {
+                        return LaunchAsync<Eigen::LLT<R, Eigen::Lower>, T, R>(L, [](const R & a, const R &) {
+                            return new Eigen::LLT<R, Eigen::Lower>{a};
+                        }, eSquare);
+                    }
+
+                    else
+                    {
+                        return LaunchAsync<Eigen::LLT<R, Eigen::Upper>, T, R>(L, [](const R & a, const R &) {
+                            return new Eigen::LLT<R, Eigen::Upper>{a};
+                        }, eSquare);
+                    }
+                }
+            }, {
+                "partialPivLuAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::PartialPivLU<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::PartialPivLU<R>{a};
+                    }, eSquare);
+                }
+            }, {
+                "selfAdjointEigenSolverAsync", [](lua_State * L)
+                {
+                    int opts = WantsBool(L, "NoEigenvectors") ? Eigen::EigenvaluesOnly : Eigen::ComputeEigenvectors;
+
+                    return LaunchAsync<Eigen::SelfAdjointEigenSolver<R>, T, R>(L, [opts](const R & a, const R &) {
+                        return new Eigen::SelfAdjointEigenSolver<R>{a, opts};
+                    }, eSquare);
+                }
+            }, {
+                "tridiagonalizationAsync", [](lua_State * L)
+                {
+                    return LaunchAsync<Eigen::Tridiagonalization<R>, T, R>(L, [](const R & a, const R &) {
+                        return new Eigen::Tridiagonalization<R>{a};
+                    }, eSquare);
+                }
+            },
+            { nullptr, nullptr }
+        };
+
+        luaL_register(L, nullptr, methods);
+        lua_getfield(L, -1, "partialPivLuAsync");	// methods, pplu_async
+        lua_setfield(L, -2, "luAsync");	// methods = { luAsync = pplu_async }
+    }
+};
+
 // No-op for integer types.
 template<typename T, typename R> struct SolverOps<T, R, false> {
 	SolverOps (lua_State *) {}
@@ -23,9 +23,13 @@
 
 #pragma once
 
+#include "async.h"
 #include "cholesky.h"
 #include "eigen_solver.h"
+#include "iterative_solver.h"
+#include "levenberg_marquardt.h"
 #include "lu.h"
 #include "misc.h"
 #include "qr.h"
+#include "refined_solver.h"
 #include "svd.h"
\ No newline at end of file
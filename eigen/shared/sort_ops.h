@@ -0,0 +1,358 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "CoronaLua.h"
+#include "utils/LuaEx.h"
+#include "types.h"
+#include "utils.h"
+#include "macros.h"
+
+//
+namespace detail_sort {
+	enum { kParallelThreshold = 1 << 16, kMaxThreads = 8 };	// Coefficients before work is split among threads; cap on those threads
+
+	// Number of threads to use on some amount of work.
+	inline unsigned ThreadCount (Eigen::Index n)
+	{
+		if (n < kParallelThreshold) return 1U;
+
+		unsigned count = std::thread::hardware_concurrency();
+
+		return (std::max)(1U, (std::min)(count, unsigned(kMaxThreads)));
+	}
+
+	// Sort a range. When large and allowed, chunks are sorted on separate threads, then merged.
+	template<typename It, typename C> void Sort (It first, It last, C comp, bool bParallel)
+	{
+		unsigned nthreads = bParallel ? ThreadCount(Eigen::Index(last - first)) : 1U;
+
+		if (nthreads < 2U)
+		{
+			std::sort(first, last, comp);
+
+			return;
+		}
+
+		std::vector<It> bounds;
+
+		for (unsigned i = 0; i <= nthreads; ++i) bounds.push_back(first + (last - first) * i / nthreads);
+
+		std::vector<std::thread> threads;
+
+		for (unsigned i = 1; i < nthreads; ++i) threads.emplace_back([&bounds, comp, i]() { std::sort(bounds[i], bounds[i + 1], comp); });
+
+		std::sort(bounds[0], bounds[1], comp);
+
+		for (auto & thread : threads) thread.join();
+
+		for (unsigned width = 1; width < nthreads; width *= 2)
+		{
+			for (unsigned i = 0; i + width < nthreads; i += 2 * width) std::inplace_merge(bounds[i], bounds[i + width], bounds[(std::min)(i + 2 * width, nthreads)], comp);
+		}
+	}
+
+	// Call a function on each lane (column of the work matrix), dividing the lanes among threads
+	// when the work is large. A lone lane is instead left to sort itself in parallel.
+	template<typename F> void ForEachLane (Eigen::Index lanes, Eigen::Index length, F && func)
+	{
+		unsigned nthreads = lanes > 1 ? unsigned((std::min)(Eigen::Index(ThreadCount(lanes * length)), lanes)) : 1U;
+		std::vector<std::thread> threads;
+
+		for (unsigned i = 1; i < nthreads; ++i)
+		{
+			threads.emplace_back([&func, i, lanes, nthreads]() {
+				for (Eigen::Index j = i; j < lanes; j += nthreads) func(j, false);
+			});
+		}
+
+		for (Eigen::Index j = 0; j < lanes; j += nthreads) func(j, lanes == 1);
+
+		for (auto & thread : threads) thread.join();
+	}
+
+	// Comparison of values, in ascending or descending order. NaNs go last either way, since the
+	// sorting algorithms require a strict weak ordering and misbehave without one.
+	template<typename S> struct Order {
+		bool mDescending;
+
+		static bool IsNaN (const S & x) { return x != x; }
+
+		bool operator () (const S & a, const S & b) const
+		{
+			if (IsNaN(a)) return false;
+			else if (IsNaN(b)) return true;
+			else return mDescending ? b < a : a < b;
+		}
+	};
+
+	// Comparison of indices by the values they reference. Ties go to the lower index, so that
+	// results do not depend on how the work was split.
+	template<typename S> struct IndexOrder {
+		const S * mValues;
+		Order<S> mOrder;
+
+		bool operator () (int a, int b) const
+		{
+			const S & va = mValues[a], & vb = mValues[b];
+
+			if (mOrder(va, vb)) return true;
+			else if (mOrder(vb, va)) return false;
+			else return a < b;
+		}
+	};
+
+	// Working copy of the input, each lane being a column.
+	template<typename R, typename M> R Lanes (const M & m, bool bRowwise)
+	{
+		if (bRowwise) return m.transpose();
+		else return m;
+	}
+
+	// Push an index matrix, converted to 1-based indices, in its lanes' original orientation.
+	inline void PushIndices (lua_State * L, Eigen::MatrixXi & indices, bool bRowwise, const char * what)
+	{
+		auto td = TypeData<Eigen::MatrixXi>::Get(L, GetTypeData::eFetchIfMissing);
+
+		if (!td) luaL_error(L, "%s() requires int matrices", what);
+
+		indices.array() += 1;
+
+		if (bRowwise) indices.transposeInPlace();
+
+		PUSH_TYPED_DATA_NO_RET(indices);// ..., indices
+	}
+
+	// Indices of each lane's coefficients, in the lane's sorted order.
+	template<typename R> Eigen::MatrixXi Argsort (const R & work, bool bDescending)
+	{
+		using S = typename R::Scalar;
+
+		Eigen::MatrixXi indices(work.rows(), work.cols());
+
+		ForEachLane(work.cols(), work.rows(), [&](Eigen::Index j, bool bParallel) {
+			int * first = indices.col(j).data(), * last = first + work.rows();
+
+			for (int * cur = first; cur != last; ++cur) *cur = int(cur - first);
+
+			Sort(first, last, IndexOrder<S>{work.col(j).data(), Order<S>{bDescending}}, bParallel);
+		});
+
+		return indices;
+	}
+
+	// Sort the coefficients along each lane: [how]
+	template<typename R, typename M> static int SortLanes (lua_State * L, const M & m, bool bRowwise)
+	{
+		using S = typename R::Scalar;
+
+		R work = Lanes<R>(m, bRowwise);
+		Order<S> order{WantsBool(L, "Descending", 2)};
+
+		ForEachLane(work.cols(), work.rows(), [&work, order](Eigen::Index j, bool bParallel) {
+			S * first = work.col(j).data();
+
+			Sort(first, first + work.rows(), order, bParallel);
+		});
+
+		if (bRowwise) work.transposeInPlace();
+
+		return NewRet<R>(L, std::move(work));
+	}
+
+	// Indices that would sort each lane, as an int matrix: [how]
+	template<typename R, typename M> static int ArgsortLanes (lua_State * L, const M & m, bool bRowwise)
+	{
+		Eigen::MatrixXi indices = Argsort(Lanes<R>(m, bRowwise), WantsBool(L, "Descending", 2));
+
+		PushIndices(L, indices, bRowwise, "argsort");	// ..., indices
+
+		return 1;
+	}
+
+	// Sort the first k coefficients of each lane into place, leaving the others in unspecified
+	// order: k[, how]
+	template<typename R, typename M> static int PartialSort (lua_State * L, const M & m, bool bRowwise)
+	{
+		using S = typename R::Scalar;
+
+		R work = Lanes<R>(m, bRowwise);
+		Eigen::Index k = LuaXS::Int(L, 2);
+		Order<S> order{WantsBool(L, "Descending", 3)};
+
+		luaL_argcheck(L, k >= 0 && k <= work.rows(), 2, "k must be between 0 and the lane length");
+
+		ForEachLane(work.cols(), work.rows(), [&work, k, order](Eigen::Index j, bool) {
+			S * first = work.col(j).data();
+
+			std::partial_sort(first, first + k, first + work.rows(), order);
+		});
+
+		if (bRowwise) work.transposeInPlace();
+
+		return NewRet<R>(L, std::move(work));
+	}
+
+	// The k largest (or smallest) coefficients of each lane, in order, and their indices: k[, how]
+	// The candidates are found by introselect, after which only they need sorting.
+	template<typename R, typename M> static int TopK (lua_State * L, const M & m, bool bRowwise)
+	{
+		using S = typename R::Scalar;
+
+		R work = Lanes<R>(m, bRowwise), values;
+		Eigen::Index k = LuaXS::Int(L, 2);
+		Eigen::MatrixXi indices;
+		Order<S> order{!WantsBool(L, "Smallest", 3)};
+
+		luaL_argcheck(L, k > 0 && k <= work.rows(), 2, "k must be between 1 and the lane length");
+
+		values.resize(k, work.cols());
+		indices.resize(work.rows(), work.cols());
+
+		ForEachLane(work.cols(), work.rows(), [&](Eigen::Index j, bool) {
+			int * first = indices.col(j).data(), * last = first + work.rows();
+			IndexOrder<S> iorder{work.col(j).data(), order};
+
+			for (int * cur = first; cur != last; ++cur) *cur = int(cur - first);
+
+			if (k < work.rows()) std::nth_element(first, first + k, last, iorder);
+
+			std::sort(first, first + k, iorder);
+
+			for (Eigen::Index i = 0; i < k; ++i) values(i, j) = work(first[i], j);
+		});
+
+		indices.conservativeResize(k, Eigen::NoChange);
+
+		if (bRowwise) values.transposeInPlace();
+
+		New<R>(L, std::move(values));	// ..., values
+
+		PushIndices(L, indices, bRowwise, "topK");	// ..., values, indices
+
+		return 2;
+	}
+
+	// The coefficient of each lane that would land at position n, were the lane sorted: n[, how]
+	template<typename R, typename M> static R NthElement (lua_State * L, const M & m, bool bRowwise)
+	{
+		using S = typename R::Scalar;
+
+		R work = Lanes<R>(m, bRowwise), nth(1, work.cols());
+		Eigen::Index n = LuaXS::Int(L, 2) - 1;
+		Order<S> order{WantsBool(L, "Descending", 3)};
+
+		luaL_argcheck(L, n >= 0 && n < work.rows(), 2, "Position must be between 1 and the lane length");
+
+		ForEachLane(work.cols(), work.rows(), [&work, &nth, n, order](Eigen::Index j, bool) {
+			S * first = work.col(j).data();
+
+			std::nth_element(first, first + n, first + work.rows(), order);
+
+			nth(0, j) = first[n];
+		});
+
+		if (!bRowwise) return nth;
+		else return nth.transpose();
+	}
+}
+
+// Ordering methods, given a way to find the lanes: LanesGetter(L) provides the object's
+// expression via Get() and a flag for row lanes via Rowwise().
+template<typename R, typename LanesGetter> struct AddSortMethods {
+	AddSortMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"argsort", [](lua_State * L)
+				{
+					LanesGetter lanes{L};
+
+					return detail_sort::ArgsortLanes<R>(L, lanes.Get(), lanes.Rowwise());
+				}
+			}, {
+				"nthElement", [](lua_State * L)
+				{
+					LanesGetter lanes{L};
+					R nth = detail_sort::NthElement<R>(L, lanes.Get(), lanes.Rowwise());
+
+					if (LanesGetter::kScalar) return LuaXS::PushArgAndReturn(L, nth(0, 0));
+					else return NewRet<R>(L, nth);
+				}
+			}, {
+				"partialSort", [](lua_State * L)
+				{
+					LanesGetter lanes{L};
+
+					return detail_sort::PartialSort<R>(L, lanes.Get(), lanes.Rowwise());
+				}
+			}, {
+				"sort", [](lua_State * L)
+				{
+					LanesGetter lanes{L};
+
+					return detail_sort::SortLanes<R>(L, lanes.Get(), lanes.Rowwise());
+				}
+			}, {
+				"topK", [](lua_State * L)
+				{
+					LanesGetter lanes{L};
+
+					return detail_sort::TopK<R>(L, lanes.Get(), lanes.Rowwise());
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// A vector is its own lane.
+template<typename R> struct VectorLanes {
+	enum { kScalar = true };
+
+	MatrixRef<R> mRef;
+
+	VectorLanes (lua_State * L) : mRef{L, 1}
+	{
+		CheckVector(L, *mRef, 1);
+	}
+
+	const typename MatrixRef<R>::Type & Get (void) const { return *mRef; }
+	bool Rowwise (void) const { return mRef->rows() == 1; }
+};
+
+// Methods assigned when the underlying type is real.
+template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsComplex> struct SortOps {
+	SortOps (lua_State * L)
+	{
+		AddSortMethods<R, VectorLanes<R>> sort_methods{L};
+	}
+};
+
+// No-op for complex types.
+template<typename T, typename R> struct SortOps<T, R, false> {
+	SortOps (lua_State *) {}
+};
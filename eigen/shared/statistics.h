@@ -0,0 +1,225 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "macros.h"
+#include "types.h"
+#include "utils.h"
+
+// Single-pass accumulator of means and (co)variances, fed observations a block at a time. Each
+// block is summarized in small chunks, which are merged into the running totals per Chan et al.,
+// so no centered copy of the data is ever made and data larger than memory may be streamed.
+template<typename R> struct StatisticsAccumulator {
+	using Scalar = typename R::Scalar;
+	using Vector = ColVector<Scalar>;
+
+	enum { kChunk = 128 };
+
+	Vector mMean;	// Running mean of each variable
+	R mM2;	// Running sums of products of deviations; only the diagonal, if not mFull
+	Eigen::Index mCount{0};	// Number of observations so far
+	bool mFull;	// Is the full covariance being tracked?
+
+	StatisticsAccumulator (Eigen::Index n, bool bFull) : mMean{Vector::Zero(n)}, mM2{R::Zero(n, bFull ? n : 1)}, mFull{bFull}
+	{
+	}
+
+	Eigen::Index size (void) const { return mMean.size(); }
+
+	// Add observations, one per row.
+	template<typename D> void Add (const Eigen::MatrixBase<D> & obs)
+	{
+		R centered;
+
+		for (Eigen::Index i = 0; i < obs.rows(); i += kChunk)
+		{
+			Eigen::Index count = (std::min)(Eigen::Index(kChunk), obs.rows() - i), total = mCount + count;
+
+			centered = obs.middleRows(i, count);
+
+			Vector mean = centered.colwise().mean().transpose(), delta = mean - mMean;
+			Scalar weight = Scalar(mCount) * Scalar(count) / Scalar(total);
+
+			centered.rowwise() -= mean.transpose();
+
+			if (mFull)
+			{
+				mM2.noalias() += centered.transpose() * centered;
+				mM2.noalias() += weight * delta * delta.transpose();
+			}
+
+			else mM2 += centered.colwise().squaredNorm().transpose() + weight * delta.cwiseAbs2();
+
+			mMean += delta * (Scalar(count) / Scalar(total));
+			mCount = total;
+		}
+	}
+
+	Scalar Divisor (bool bPopulation) const
+	{
+		return Scalar(bPopulation ? mCount : mCount - 1);
+	}
+
+	Vector variance (bool bPopulation) const
+	{
+		if (mFull) return mM2.diagonal() / Divisor(bPopulation);
+		else return mM2.col(0) / Divisor(bPopulation);
+	}
+
+	R covariance (bool bPopulation) const
+	{
+		return mM2 / Divisor(bPopulation);
+	}
+
+	R correlation (void) const
+	{
+		Vector inv_sd = mM2.diagonal().cwiseSqrt().cwiseInverse();
+
+		return inv_sd.asDiagonal() * mM2 * inv_sd.asDiagonal();
+	}
+
+	void reset (void)
+	{
+		mMean.setZero();
+		mM2.setZero();
+
+		mCount = 0;
+	}
+};
+
+/********************************
+* StatisticsAccumulator methods *
+********************************/
+template<typename U, typename R> struct AttachMethods<StatisticsAccumulator<U>, R> {
+	using Getters = InstanceGetters<StatisticsAccumulator<U>, R>;
+
+	// Read the "Population" option and check that enough observations were seen for the
+	// divisor: at least one for population statistics and two for sample ones.
+	static bool CheckCount (lua_State * L, const StatisticsAccumulator<U> & acc, bool bPopulation)
+	{
+		luaL_argcheck(L, acc.mCount > (bPopulation ? 0 : 1), 1, "Too few observations");
+
+		return bPopulation;
+	}
+
+	AttachMethods (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"add", [](lua_State * L)
+				{
+					StatisticsAccumulator<U> & acc = *Getters::GetT(L);
+
+					// Raw memory, e.g. a blob, is read in place as a block of rows, matching the byte
+					// order of setFromBytes() and asBytes().
+					if (!GetTypeData::FromObject(L, 2))
+					{
+						ByteReader bytes{L, 2};
+
+						if (!bytes.mBytes) lua_error(L);
+
+						size_t row_size = sizeof(typename R::Scalar) * size_t(acc.size());
+
+						luaL_argcheck(L, bytes.mCount % row_size == 0, 2, "Byte count is not a multiple of the row size");
+
+						Eigen::Index n = Eigen::Index(bytes.mCount / row_size);
+
+						using RowMajor = Eigen::Matrix<typename R::Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+						acc.Add(Eigen::Map<const RowMajor>{reinterpret_cast<const typename R::Scalar *>(bytes.mBytes), n, acc.size()});
+					}
+
+					else
+					{
+						MatrixRef<R> obs{L, 2};
+
+						luaL_argcheck(L, obs->cols() == acc.size(), 2, "Column count does not match variable count");
+
+						acc.Add(*obs);
+					}
+
+					return SelfForChaining(L);	// acc, obs, acc
+				}
+			}, {
+				"correlation", [](lua_State * L)
+				{
+					StatisticsAccumulator<U> & acc = *Getters::GetT(L);
+
+					luaL_argcheck(L, acc.mFull, 1, "Accumulator does not track covariance");
+
+					CheckCount(L, acc, false);
+
+					return NewRet<R>(L, acc.correlation());	// acc, corr
+				}
+			}, {
+				"count", [](lua_State * L)
+				{
+					return LuaXS::PushArgAndReturn(L, Getters::GetT(L)->mCount);
+				}
+			}, {
+				"covariance", [](lua_State * L)
+				{
+					StatisticsAccumulator<U> & acc = *Getters::GetT(L);
+
+					luaL_argcheck(L, acc.mFull, 1, "Accumulator does not track covariance");
+
+					return NewRet<R>(L, acc.covariance(CheckCount(L, acc, WantsBool(L, "Population", 2))));	// acc[, how], cov
+				}
+			}, {
+				"mean", [](lua_State * L)
+				{
+					return NewRet<R>(L, Getters::GetT(L)->mMean.transpose());	// acc, mean
+				}
+			}, {
+				"reset", [](lua_State * L)
+				{
+					Getters::GetT(L)->reset();
+
+					return SelfForChaining(L);	// acc, acc
+				}
+			}, {
+				"variance", [](lua_State * L)
+				{
+					StatisticsAccumulator<U> & acc = *Getters::GetT(L);
+
+					return NewRet<R>(L, acc.variance(CheckCount(L, acc, WantsBool(L, "Population", 2))).transpose());	// acc[, how], var
+				}
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+template<typename T> struct AuxTypeName<StatisticsAccumulator<T>> {
+	AuxTypeName (luaL_Buffer * B, lua_State * L)
+	{
+		luaL_addstring(B, "StatisticsAccumulator<");
+
+		AuxTypeName<T>(B, L);
+
+		luaL_addstring(B, ">");
+	}
+};
@@ -23,6 +23,9 @@
 
 #pragma once
 
+// Used to report failed asserts on worker threads.
+#include <stdexcept>
+
 // Corona bits...
 #include "CoronaLua.h"
 #include "CoronaLibrary.h"
@@ -36,19 +39,42 @@
 // Propagate asserts to Lua. This is bound in implementation.h.
 static ThreadXS::TLS<lua_State *> tls_LuaState;
 
+// Worker threads have no Lua state, so a failed assert there is instead thrown, unwinding back
+// to the worker to be reported later. This is set by AsyncDecomposition.
+static ThreadXS::TLS<bool> tls_OnWorker;
+
+inline void EigenAssertFailed (const char * what)
+{
+	if (tls_OnWorker) throw std::runtime_error{what};
+
+	luaL_error(tls_LuaState, "%s", what);
+}
+
 #ifndef eigen_assert
-	#define eigen_assert(x) if (!(x)) luaL_error(tls_LuaState, "Eigen error: " #x);
+	#define eigen_assert(x) if (!(x)) EigenAssertFailed("Eigen error: " #x);
 #endif
 
 // STL...
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <complex>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 // ...and Eigen itself.
 #include <Eigen/Eigen>
+#include <unsupported/Eigen/MatrixFunctions>
 
 // Forward declarations.
 template<typename R, bool bSetTemp = false> R * SetTemp (lua_State * L, R * temp, int arg, bool bMissingOK = false);
@@ -26,6 +26,8 @@
 #include "types.h"
 #include "utils.h"
 #include "macros.h"
+#include "bit_matrix.h"
+#include "diagonal.h"
 #include "self_adjoint_view.h"
 #include "triangular_view.h"
 #include "vectorwise.h"
@@ -62,6 +64,9 @@ namespace details_stock {
 						using M = MatrixOf<typename T::Scalar>;
                     
                         T & m = *Getters::GetT(L);
+
+						luaL_argcheck(L, m.innerStride() == 1 && m.outerStride() == m.rows(), 1, "Only contiguous storage may be reshaped");	// e.g. not complex component views
+
 						Eigen::Map<M> map{m.data(), LuaXS::Int(L, 2), LuaXS::Int(L, 3)};
                     
 						NEW_REF1_DECLTYPE_MOVE("mapped_from", map);	// mat, m, n, map
@@ -229,7 +234,9 @@ template<typename T, typename R> struct StockOps {
         
 		luaL_Reg methods[] = {
 			{
-				EIGEN_MATRIX_GET_MATRIX_METHOD(asDiagonal)
+				"asDiagonal", detail_diag::AsDiagonal<T, R>::Do
+			}, {
+				"asBytes", AsBytes<T>
 			}, {
 				"asMatrix", AsMatrix<T, R>
 			}, {
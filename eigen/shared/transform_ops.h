@@ -0,0 +1,227 @@
+/*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+* [ MIT license: http://www.opensource.org/licenses/mit-license.php ]
+*/
+
+#pragma once
+
+#include "types.h"
+#include "utils.h"
+#include "simd_dispatch.h"
+
+namespace detail_transform {
+	// Linear and translation parts of a 3D transform, together with options for the batch.
+	template<typename R> struct Transform3 {
+		using Scalar = typename R::Scalar;
+
+		enum { kChunk = 256 };	// Points per batch, sized to keep each temporary on the stack
+
+		Eigen::Matrix<Scalar, 3, 3> mLinear;// Linear part, or its inverse transpose for normals
+		Eigen::Matrix<Scalar, 3, 1> mOffset;// Translation part, if any
+		bool mNormalize{false};	// Renormalize results? (normals only)
+		bool mThreaded{false};	// Split batches among threads? (A hint, honored only in OpenMP builds)
+
+		// Read a 3x3 (linear), 3x4 (affine), or 4x4 (homogeneous, affine part used) transform.
+		Transform3 (lua_State * L, bool bNormals)
+		{
+			R xform = GetInstanceEx<R>(L, 1);
+
+			luaL_argcheck(L, xform.rows() == 3 || xform.rows() == 4, 1, "Transform must have 3 or 4 rows");
+			luaL_argcheck(L, xform.cols() == 3 || xform.cols() == 4, 1, "Transform must have 3 or 4 columns");
+			luaL_argcheck(L, xform.rows() <= xform.cols(), 1, "Transform may not have more rows than columns");
+
+			mLinear = xform.template topLeftCorner<3, 3>();
+
+			if (xform.cols() == 4) mOffset = xform.template topRightCorner<3, 1>();
+			else mOffset.setZero();
+
+			// Normals go through the inverse transpose, so a degenerate transform has none.
+			if (bNormals)
+			{
+				Eigen::Matrix<Scalar, 3, 3> inverse;
+				bool bInvertible;
+
+				mLinear.computeInverseWithCheck(inverse, bInvertible);
+
+				luaL_argcheck(L, bInvertible, 1, "Transform has a singular linear part");
+
+				mLinear = inverse.transpose();
+			}
+
+			// Read any options, which will follow the points and optional output.
+			int top = lua_gettop(L);
+
+			if (top >= 3 && lua_istable(L, top))
+			{
+				lua_getfield(L, top, "normalize");	// xform, pts[, out], opts, normalize
+				lua_getfield(L, top, "threaded");	// xform, pts[, out], opts, normalize, threaded
+
+				mNormalize = bNormals && lua_toboolean(L, -2);
+				mThreaded = lua_toboolean(L, -1) != 0;
+
+				lua_pop(L, 2);	// xform, pts[, out], opts
+			}
+		}
+
+		// Transform points stored as columns, i.e. 3xN. Each batch goes through a temporary, so
+		// the input and output may be the same object.
+		template<typename In, typename Out> void Columns (const In & in, Out & out, bool bAffine) const
+		{
+			Eigen::Index n = in.cols();
+
+			#ifdef _OPENMP
+			#pragma omp parallel for if (mThreaded)
+			#endif
+			for (Eigen::Index i = 0; i < n; i += kChunk)
+			{
+				Eigen::Index count = (std::min)(Eigen::Index(kChunk), n - i);
+				Eigen::Matrix<Scalar, 3, Eigen::Dynamic, Eigen::ColMajor, 3, kChunk> temp{3, count};
+
+				temp.noalias() = mLinear * in.middleCols(i, count);
+
+				if (bAffine) temp.colwise() += mOffset;
+				if (mNormalize) temp.colwise().normalize();
+
+				out.middleCols(i, count) = temp;
+			}
+		}
+
+		// Transform points stored as rows, i.e. Nx3. With column-major storage each coordinate
+		// is contiguous, so the batch products vectorize along the points. Such batches go
+		// through the dispatched kernels, when available for this scalar type.
+		template<typename In, typename Out> void Rows (const In & in, Out & out, bool bAffine) const
+		{
+			Eigen::Index n = in.rows();
+
+			if (RowsWithKernel(in, out, bAffine, detail_simd::IsDispatched<Scalar>{})) return;
+
+			#ifdef _OPENMP
+			#pragma omp parallel for if (mThreaded)
+			#endif
+			for (Eigen::Index i = 0; i < n; i += kChunk)
+			{
+				Eigen::Index count = (std::min)(Eigen::Index(kChunk), n - i);
+				Eigen::Matrix<Scalar, Eigen::Dynamic, 3, Eigen::ColMajor, kChunk, 3> temp{count, 3};
+
+				temp.noalias() = in.middleRows(i, count) * mLinear.transpose();
+
+				if (bAffine) temp.rowwise() += mOffset.transpose();
+				if (mNormalize) temp.rowwise().normalize();
+
+				out.middleRows(i, count) = temp;
+			}
+		}
+
+		template<typename In, typename Out> bool RowsWithKernel (const In &, Out &, bool, std::false_type) const
+		{
+			return false;
+		}
+
+		template<typename In, typename Out> bool RowsWithKernel (const In & in, Out & out, bool bAffine, std::true_type) const
+		{
+			auto transform = detail_simd::Get<Scalar>().mTransformRows;
+			Eigen::Index n = in.rows();
+
+			#ifdef _OPENMP
+			#pragma omp parallel for if (mThreaded)
+			#endif
+			for (Eigen::Index i = 0; i < n; i += kChunk)
+			{
+				Eigen::Index count = (std::min)(Eigen::Index(kChunk), n - i);
+				const Scalar * from[3] = { &in.coeffRef(i, 0), &in.coeffRef(i, 1), &in.coeffRef(i, 2) };
+				Scalar * to[3] = { &out.coeffRef(i, 0), &out.coeffRef(i, 1), &out.coeffRef(i, 2) };
+
+				transform(from, to, count, mLinear.data(), mOffset.data(), bAffine, mNormalize);
+			}
+
+			return true;
+		}
+	};
+
+	// Common body of the batch transforms: xform, pts[, out][, opts]. Results are written to
+	// the output, if provided (this may be pts itself); otherwise to a new matrix.
+	template<typename R> static int Transform (lua_State * L, bool bNormals)
+	{
+		Transform3<R> xf{L, bNormals};
+		MatrixRef<R> pts{L, 2};
+
+		bool bColumns = pts->rows() == 3;
+
+		luaL_argcheck(L, bColumns || pts->cols() == 3, 2, "Points must be 3xN or Nx3");
+
+		// Bind the output, creating it if absent.
+		WritableMatrixRef<R> out;
+
+		if (lua_isuserdata(L, 3))
+		{
+			out.Init(L, 3);
+
+			luaL_argcheck(L, out->rows() == pts->rows() && out->cols() == pts->cols(), 3, "Output dimensions do not match points");
+
+			lua_pushvalue(L, 3);// xform, pts, out[, opts], out
+		}
+
+		else
+		{
+			New<R>(L, pts->rows(), pts->cols());// xform, pts[, opts], out
+
+			out.Init(L, lua_gettop(L));
+		}
+
+		if (bColumns) xf.Columns(*pts, *out, !bNormals);
+		else xf.Rows(*pts, *out, !bNormals);
+
+		return 1;
+	}
+
+	template<typename R> static int TransformNormals (lua_State * L)
+	{
+		return Transform<R>(L, true);
+	}
+
+	template<typename R> static int TransformPoints (lua_State * L)
+	{
+		return Transform<R>(L, false);
+	}
+}
+
+// Methods assigned when the underlying type is real floating point. These only depend on
+// the matrix family, since the transform itself is resolved to one of those.
+template<typename T, typename R, bool = !Eigen::NumTraits<typename T::Scalar>::IsInteger && !Eigen::NumTraits<typename T::Scalar>::IsComplex> struct TransformOps {
+	TransformOps (lua_State * L)
+	{
+		luaL_Reg methods[] = {
+			{
+				"transformNormals", detail_transform::TransformNormals<R>
+			}, {
+				"transformPoints", detail_transform::TransformPoints<R>
+			},
+			{ nullptr, nullptr }
+		};
+
+		luaL_register(L, nullptr, methods);
+	}
+};
+
+// No-op for integer and complex types.
+template<typename T, typename R> struct TransformOps<T, R, false> {
+	TransformOps (lua_State *) {}
+};
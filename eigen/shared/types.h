@@ -30,11 +30,28 @@ template<typename T> using ColVector = Eigen::Matrix<T, Eigen::Dynamic, 1>;
 template<typename T> using RowVector = Eigen::Matrix<T, 1, Eigen::Dynamic>;
 template<typename T, int O = 0, typename S = Eigen::Stride<0, 0>> using MappedColVector = Eigen::Map<ColVector<T>, O, S>;
 template<typename T, int O = 0, typename S = Eigen::Stride<0, 0>> using MappedRowVector = Eigen::Map<RowVector<T>, O, S>;
+
+// Strided view of the real or imaginary parts of complex storage.
+template<typename R> using ComponentMap = Eigen::Map<R, 0, Eigen::Stride<Eigen::Dynamic, 2>>;
 template<typename S, int Rows = Eigen::Dynamic, int Cols = Eigen::Dynamic> using MatrixOf = Eigen::Matrix<S, Rows, Cols>;
 
 // Matrices of booleans.
 typedef MatrixOf<bool> BoolMatrix;
 
+// Compact integer matrices, e.g. for pixels and ids, that Eigen does not name.
+typedef MatrixOf<int64_t> Int64Matrix;
+typedef MatrixOf<int16_t> Int16Matrix;
+typedef MatrixOf<uint8_t> Uint8Matrix;
+
+// Half-precision matrices, used for storage; arithmetic on them is carried out in float.
+typedef MatrixOf<Eigen::half> HalfMatrix;
+
+// No-copy view of a boolean matrix, map, or block, e.g. when used as a mask.
+typedef Eigen::Ref<const BoolMatrix, 0, Eigen::OuterStride<>> BoolMatrixRef;
+
+// Packed boolean matrix; see bit_matrix.h.
+struct BitMatrix;
+
 // Trait to detect expression types, as these often require special handling.
 template<typename T> struct IsXpr : std::false_type {};
 template<typename U, int R, int C, bool B> struct IsXpr<Eigen::Block<U, R, C, B>> : std::true_type {};
@@ -66,14 +83,19 @@ template<typename U> struct HasNormalStride<Eigen::Map<U>> : std::true_type {};
 // for the matrix family in question.
 template<typename R> struct IsMatrixFamilyImplemented : std::false_type {};
 
+// Trait that flags whether an object may be resolved to its matrix family via "asMatrix". Types
+// that supply that method without a C++ conversion, e.g. packed storage, specialize this.
+template<typename T, typename R> struct IsConvertibleToMatrix : std::is_convertible<T, R> {};
+
 // Associate some numeric constants with each scalar type. Also, count the number
 // of bits needed to pack them into a bitfield in the type data.
 // See e.g. https://hbfs.wordpress.com/2016/03/22/log2-with-c-metaprogramming/
 template<int N> struct CompileTimeBits : std::integral_constant<int, CompileTimeBits<N / 2>::value + 1> {};
 template<> struct CompileTimeBits<1> : std::integral_constant<int, 1> {};
 
-enum ScalarType {
-	eInt, eFloat, eDouble, eCfloat, eCdouble, eBool,
+// The underlying type is unsigned so that bit-fields of this type hold every value.
+enum ScalarType : unsigned {
+	eInt, eFloat, eDouble, eCfloat, eCdouble, eBool, eInt64, eInt16, eUint8, eHalf,
 	kNumTypes,
 	kBits = CompileTimeBits<kNumTypes>::value
 };
@@ -85,10 +107,15 @@ template<> struct GetScalarType<double> : std::integral_constant<ScalarType, eDo
 template<> struct GetScalarType<std::complex<float>> : std::integral_constant<ScalarType, eCfloat> {};
 template<> struct GetScalarType<std::complex<double>> : std::integral_constant<ScalarType, eCdouble> {};
 template<> struct GetScalarType<bool> : std::integral_constant<ScalarType, eBool> {};
+template<> struct GetScalarType<int64_t> : std::integral_constant<ScalarType, eInt64> {};
+template<> struct GetScalarType<int16_t> : std::integral_constant<ScalarType, eInt16> {};
+template<> struct GetScalarType<uint8_t> : std::integral_constant<ScalarType, eUint8> {};
+template<> struct GetScalarType<Eigen::half> : std::integral_constant<ScalarType, eHalf> {};
 
 // Keys to some global state for the type system.
 #define EIGEN_META_TO_TYPE_DATA_KEY "EIGEN::META_TO_TYPE_DATA"
 #define EIGEN_NEW_TYPE_KEY "EIGEN::NEW_TYPE"
+#define EIGEN_HEAP_USAGE_KEY "EIGEN::HEAP_USAGE"
 
 // Various ways to acquire type data that might not yet be present. This is a base type in
 // order to avoid dealing with templates for simple lookups, as well as to service any
@@ -102,10 +129,25 @@ struct GetTypeData {
 		ScalarType mType : kBits;	// The type corresponding to Scalar
 	};
 
-	int mSelectRef{LUA_NOREF};	// Method used to select some matrix / scalar combination
+	// Native select() kernels, supplied by the module implementing the family. These are called
+	// directly, even from other modules, with "then" and "else" in positions 2 and 3.
+	struct SelectFuncs {
+		int (*mWithMask)(lua_State *, const BoolMatrixRef &, bool, bool);
+		int (*mWithBits)(lua_State *, const BitMatrix &, bool, bool);
+	};
+
+	// Native hook, supplied by the module implementing a real floating point family, that pushes
+	// a view of complex storage's real or imaginary parts: data, rows, cols, complex outer stride.
+	// The complex object is expected in position 1, and is kept alive by the view.
+	using PushComponentViewFunc = int (*)(lua_State *, void *, Eigen::Index, Eigen::Index, Eigen::Index);
+
+	SelectFuncs mSelect{};	// Kernels used to select some matrix / scalar combination
+	PushComponentViewFunc mPushComponentView{nullptr};	// Pushes real or imaginary part views, if available
 	Info mInfo;	// Some information about the type
 	const char * mName;	// Cached full name
 	void * mDatum{nullptr};	// Pointer to transient datum for some quick operations
+	size_t mLiveBytes{0};	// Heap bytes held by live instances
+	size_t mLiveCount{0};	// Number of live instances
 
 	const Info & GetInfo (void) const { return mInfo; }
 	const char * GetName (void) const { return mName; }
@@ -138,16 +180,154 @@ struct GetTypeData {
 		return td;
 	}
 
-	// Invoke select logic for the type.
-	int Select (lua_State * L)
+	// Find the select() kernels appropriate to the "then" and "else" objects, noting which of
+	// these are matrices rather than scalars. Operands may be any mix of matrices, maps, and
+	// so on, as long as they belong to the same family.
+	static const SelectFuncs & GetSelectFuncs (lua_State * L, bool & bThen, bool & bElse)
 	{
-		luaL_argcheck(L, mSelectRef != LUA_NOREF, -1, "Type does not support select()");
-		lua_getref(L, mSelectRef);	// bm, then, else, select
-		lua_insert(L, 1);	// select, bm, then, else
-		lua_settop(L, 4);	// select, bm, then, else
-		lua_call(L, 3, 1);	// selection
+		GetTypeData * td1 = FromObject(L, 2);
+		GetTypeData * td2 = FromObject(L, 3);
 
-		return 1;
+		luaL_argcheck(L, td1 || td2, 2, "Two scalars supplied to select()");
+		luaL_argcheck(L, !td1 || !td2 || td1->GetInfo().mType == td2->GetInfo().mType, 2, "Mixed types supplied to select()");
+
+		// Packed or otherwise non-convertible operands are resolved by the other one's kernels.
+		GetTypeData * td = td1 && td1->mSelect.mWithMask ? td1 : td2;
+
+		luaL_argcheck(L, td && td->mSelect.mWithMask, td1 ? 2 : 3, "Type does not support select()");
+
+		bThen = td1 != nullptr;
+		bElse = td2 != nullptr;
+
+		return td->mSelect;
+	}
+};
+
+// Heap bytes owned by an object, beyond its userdata. Only dynamic matrices (and packed masks)
+// are measured; decompositions and the like report nothing.
+template<typename T> struct HeapBytes {
+	static size_t Get (const T &) { return 0; }
+};
+
+template<typename U, int Rows, int Cols, int Options, int MaxRows, int MaxCols> struct HeapBytes<Eigen::Matrix<U, Rows, Cols, Options, MaxRows, MaxCols>> {
+	static size_t Get (const Eigen::Matrix<U, Rows, Cols, Options, MaxRows, MaxCols> & m)
+	{
+		return Rows == Eigen::Dynamic || Cols == Eigen::Dynamic ? size_t(m.size()) * sizeof(U) : 0U;
+	}
+};
+
+// Bookkeeping for memory that Lua's collector cannot see. Matrix buffers live on the C++ heap,
+// so a large matrix looks like a small userdata and garbage would otherwise pile up. Bytes are
+// tallied per type as instances come and go, and allocations are fed to the collector as extra
+// steps once enough of them accumulate. This lives in the registry, shared by all modules, for
+// the life of the state. It is looked up afresh each time, since several states may come and
+// go on one thread, and once finalized it is no longer found, instances possibly outliving it.
+struct HeapUsage {
+	std::unordered_map<const void *, size_t> mAccounted;// Bytes tallied for each instance holding any
+	std::unordered_map<const void *, size_t> mParked;	// Bytes of cached instances kept for recycling
+	size_t mLiveBytes{0};	// Heap bytes held by all live instances
+	size_t mRecycledBytes{0};	// Heap bytes held back by cached instances, for reuse
+	size_t mPending{0};	// Bytes allocated since the collector was last stepped
+	size_t mThreshold{1U << 20};// Pending bytes that trigger a step; if 0, the collector is never stepped
+	double mStepScale{1};	// Multiplier applied to the pending bytes when stepping
+	bool mRecycleBuffers{false};// Do cached matrices keep their buffers for reuse?
+
+	// Fetch the state's bookkeeping, creating it on first use. This is null once the state is
+	// closing and the bookkeeping has been finalized.
+	static HeapUsage * Get (lua_State * L)
+	{
+		lua_getfield(L, LUA_REGISTRYINDEX, EIGEN_HEAP_USAGE_KEY);	// ..., usage?
+
+		if (lua_isnil(L, -1))
+		{
+			lua_pop(L, 1);	// ...
+
+			LuaXS::NewTyped<HeapUsage>(L);	// ..., usage
+
+			lua_createtable(L, 0, 1);	// ..., usage, meta
+			lua_pushcfunction(L, [](lua_State * L) {
+				LuaXS::UD<HeapUsage>(L, 1)->~HeapUsage();
+
+				lua_pushboolean(L, 0);	// usage, false
+				lua_setfield(L, LUA_REGISTRYINDEX, EIGEN_HEAP_USAGE_KEY);	// usage; registry = { ..., HEAP_USAGE_KEY = false }
+
+				return 0;
+			});	// ..., usage, meta, GC
+			lua_setfield(L, -2, "__gc");// ..., usage, meta = { __gc = GC }
+			lua_setmetatable(L, -2);// ..., usage
+
+			lua_pushvalue(L, -1);	// ..., usage, usage
+			lua_setfield(L, LUA_REGISTRYINDEX, EIGEN_HEAP_USAGE_KEY);	// ..., usage; registry = { ..., HEAP_USAGE_KEY = usage }
+		}
+
+		HeapUsage * usage = lua_isuserdata(L, -1) ? LuaXS::UD<HeapUsage>(L, -1) : nullptr;
+
+		lua_pop(L, 1);	// ...
+
+		return usage;
+	}
+
+	// Tally an instance's bytes, as of now. Sizes may later change in place, e.g. by resize(), so
+	// these are recorded and removed as such.
+	void Add (lua_State * L, GetTypeData * td, const void * object, size_t bytes, size_t allocated)
+	{
+		if (bytes) mAccounted[object] = bytes;
+
+		td->mLiveBytes += bytes;
+		mLiveBytes += bytes;
+		mPending += allocated;
+
+		if (mThreshold && mPending >= mThreshold)
+		{
+			int kb = int(double(mPending) * mStepScale / 1024);
+
+			mPending = 0;
+
+			if (kb > 0) lua_gc(L, LUA_GCSTEP, kb);
+		}
+	}
+
+	// Move a cached instance's bytes from the live tally to the recycled one.
+	void Park (GetTypeData * td, const void * object)
+	{
+		auto iter = mAccounted.find(object);
+
+		if (iter != mAccounted.end())
+		{
+			td->mLiveBytes -= iter->second;
+			mLiveBytes -= iter->second;
+			mRecycledBytes += iter->second;
+
+			mParked[object] = iter->second;
+
+			mAccounted.erase(iter);
+		}
+	}
+
+	// Withdraw whatever was tallied for an instance, whether live or parked.
+	void Remove (GetTypeData * td, const void * object)
+	{
+		auto iter = mAccounted.find(object);
+
+		if (iter != mAccounted.end())
+		{
+			td->mLiveBytes -= iter->second;
+			mLiveBytes -= iter->second;
+
+			mAccounted.erase(iter);
+		}
+
+		else
+		{
+			iter = mParked.find(object);
+
+			if (iter != mParked.end())
+			{
+				mRecycledBytes -= iter->second;
+
+				mParked.erase(iter);
+			}
+		}
 	}
 };
 
@@ -158,21 +338,37 @@ template<typename T, typename U> int NewRet (lua_State *, U &&);
 template<typename T> T * GetInstance (lua_State *, int = -1);
 template<typename R> R GetInstanceEx (lua_State *, int = 1);
 template<typename T, typename R = MatrixOf<typename T::Scalar>> struct TypeData;
+template<typename R> struct MatrixRef;
+template<typename T> typename T::Scalar AsScalar (lua_State * L, int arg);
 
 //
 namespace detail {
-	//
-	template<typename R> static int Select (lua_State * L)
+	// Select from "then" and "else" operands in positions 2 and 3, per a BoolMatrix or BitMatrix
+	// mask. Matrix operands are bound in place when their storage allows it.
+	template<typename R, typename M> static int Select (lua_State * L, const M & mask, bool bThen, bool bElse)
 	{
-		auto bm = LuaXS::UD<BoolMatrix>(L, 1); // see the note in BoolMatrix::select()
+		Eigen::Index rows = mask.rows(), cols = mask.cols();
+
+		if (bThen && bElse)
+		{
+			MatrixRef<R> m1{L, 2}, m2{L, 3};
+
+			luaL_argcheck(L, m1->rows() == rows && m1->cols() == cols, 2, "Mismatched select() dimensions");
+			luaL_argcheck(L, m2->rows() == rows && m2->cols() == cols, 3, "Mismatched select() dimensions");
 
-		return NewRet<R>(L, WithMatrixScalarCombination<R>(L, [bm](const R & m1, const R & m2) {
-			return bm->select(m1, m2);
-		}, [bm](const R & m, const typename R::Scalar & s) {
-			return bm->select(m, s);
-		}, [bm](const typename R::Scalar & s, const R & m) {
-			return bm->select(s, m);
-		}, 2, 3));
+			return NewRet<R>(L, mask.select(*m1, *m2));
+		}
+
+		else
+		{
+			MatrixRef<R> m{L, bThen ? 2 : 3};
+			auto s = R::Constant(rows, cols, AsScalar<R>(L, bThen ? 3 : 2));
+
+			luaL_argcheck(L, m->rows() == rows && m->cols() == cols, bThen ? 2 : 3, "Mismatched select() dimensions");
+
+			if (bThen) return NewRet<R>(L, mask.select(*m, s));
+			else return NewRet<R>(L, mask.select(s, *m));
+		}
 	}
 
     // Add push and select functions, allowing interop with code that may be in other modules.
@@ -184,10 +380,10 @@ namespace detail {
             lua_pushcfunction(L, [](lua_State * L) {
                 return NewRet<R>(L, *LuaXS::UD<T>(L, 1));
             });	// meta, push
-            lua_pushcfunction(L, Select<R>);// meta, push, select
             
-            td->mSelectRef = lua_ref(L, 1);	// ..., push; registry = { ..., ref = select }
-            td->mPushRef = lua_ref(L, 1);	// ...; registry = { ..., select, ref = push }
+            td->mPushRef = lua_ref(L, 1);	// ...; registry = { ..., ref = push }
+            td->mSelect.mWithMask = Select<R, BoolMatrixRef>;
+            td->mSelect.mWithBits = Select<R, BitMatrix>;
         }
     };
     
@@ -195,6 +391,27 @@ namespace detail {
         AddPushAndSelect (lua_State *, TypeData<T> *) {}
     };
 
+    // Add the hook used by complex families, possibly in other modules, to view their real and
+    // imaginary parts in place. The views belong to this (real) family.
+    template<typename T, typename R, bool = std::is_same<T, R>::value && std::is_floating_point<typename R::Scalar>::value> struct AddComponentViews {
+        AddComponentViews (TypeData<T> * td)
+        {
+            td->mPushComponentView = [](lua_State * L, void * data, Eigen::Index rows, Eigen::Index cols, Eigen::Index outer_stride) {
+                ComponentMap<R> map{static_cast<typename R::Scalar *>(data), rows, cols, Eigen::Stride<Eigen::Dynamic, 2>{2 * outer_stride, 2}};
+
+                NewRet<ComponentMap<R>>(L, std::move(map));	// source, ..., view
+
+                TypeData<ComponentMap<R>>::Get(L)->RefAt(L, "component_of", 1);
+
+                return 1;
+            };
+        }
+    };
+
+    template<typename T, typename R> struct AddComponentViews<T, R, false> {
+        AddComponentViews (TypeData<T> *) {}
+    };
+
     //
     template<typename T> struct OnCache : std::false_type {
         static int Do (lua_State * L) { return 0; }
@@ -205,11 +422,70 @@ namespace detail {
         {
             using M = Eigen::Matrix<U, Rows, Cols, Options, MaxRows, MaxCols>;
             
-            *LuaXS::UD<M>(L, 1) = M{};
+            HeapUsage * usage = HeapUsage::Get(L);
+            M & m = *LuaXS::UD<M>(L, 1);
+
+            // When recycling, the buffer is kept for whichever object next reuses this one, and
+            // is tallied apart from the live instances until then.
+            if (usage && usage->mRecycleBuffers) usage->Park(TypeData<M>::Get(L), &m);
+
+            else
+            {
+                if (usage) usage->Remove(TypeData<M>::Get(L), &m);
+
+                m = M{};
+            }
             
             return 0;
         }
     };
+
+    // Rebuild a cached object with new contents. This is normally done by destruction and
+    // construction in place, but when buffer recycling is enabled a matrix is instead assigned
+    // to or resized, so that shapes seen in one frame loop iteration are served without going
+    // through the heap in the next. Other objects, and argument combinations that a matrix
+    // cannot be assigned from, take the usual route.
+    template<typename T> struct Reuse {
+        template<typename ... Args> static bool Do (lua_State * L, T * object, bool, Args && ... args)
+        {
+            LuaXS::DestructTyped<T>(L, -1);
+
+            new (object) T(std::forward<Args>(args)...);
+
+            return false;
+        }
+    };
+
+    template<typename U, int Rows, int Cols, int Options, int MaxRows, int MaxCols> struct Reuse<Eigen::Matrix<U, Rows, Cols, Options, MaxRows, MaxCols>> {
+        using M = Eigen::Matrix<U, Rows, Cols, Options, MaxRows, MaxCols>;
+
+        template<typename ... Args> static bool Try (long, M &, Args && ...) { return false; }
+
+        template<typename A> static auto Try (int, M & m, A && a) -> decltype(m = std::forward<A>(a), true)
+        {
+            m = std::forward<A>(a);
+
+            return true;
+        }
+
+        template<typename A, typename B> static auto Try (int, M & m, A && rows, B && cols) -> typename std::enable_if<std::is_integral<typename std::decay<A>::type>::value && std::is_integral<typename std::decay<B>::type>::value, bool>::type
+        {
+            m.resize(rows, cols);
+
+            return true;
+        }
+
+        template<typename ... Args> static bool Do (lua_State * L, M * object, bool bRecycle, Args && ... args)
+        {
+            if (bRecycle && Try(0, *object, std::forward<Args>(args)...)) return true;
+
+            LuaXS::DestructTyped<M>(L, -1);
+
+            new (object) M(std::forward<Args>(args)...);
+
+            return false;
+        }
+    };
     
     //
     template<typename TD, typename R, bool = IsMatrixFamilyImplemented<R>::value> struct Create {
@@ -247,11 +523,12 @@ namespace detail {
             td->mCacheFuncRef = lua_ref(L, 1);	// ..., name
             
             // Hook up routines to push a matrix, e.g. from another shared library, and with similar
-            // reasoning to use such matrices in BoolMatrix::select().
+            // reasoning to use such matrices in BoolMatrix::select() and BitMatrix::select().
             AddPushAndSelect<T, R> apas{L, td};
+            AddComponentViews<T, R> acv{td};
             
             // Capture some information needed when the exact type is unknown.
-            td->mInfo.mIsConvertible = std::is_convertible<T, R>::value;
+            td->mInfo.mIsConvertible = IsConvertibleToMatrix<T, R>::value;
             td->mInfo.mIsPrimitive = std::is_same<T, R>::value;
             td->mInfo.mType = GetScalarType<typename R::Scalar>::value;
             
@@ -430,11 +707,17 @@ template<typename T, typename ... Args> T * New (lua_State * L, Args && ... args
 
 	else lua_pop(L, 1);	// ...
 
+	HeapUsage * usage = HeapUsage::Get(L);
+	size_t before = 0U;
+	bool bRecycled = false;
+
 	if (object)
 	{
-		LuaXS::DestructTyped<T>(L, -1);
+		before = HeapBytes<T>::Get(*object);
 
-		new (object) T(std::forward<Args>(args)...);
+		if (usage) usage->Remove(td, object);
+
+		bRecycled = detail::Reuse<T>::Do(L, object, usage && usage->mRecycleBuffers, std::forward<Args>(args)...);
 	}
 
 	// Otherwise, add a new object. If the type itself is new, attach its methods as well.
@@ -442,6 +725,8 @@ template<typename T, typename ... Args> T * New (lua_State * L, Args && ... args
 	{
 		object = LuaXS::NewTyped<T>(L, std::forward<Args>(args)...);// ..., object
 
+		++td->mLiveCount;
+
 		LuaXS::AttachMethods(L, td->GetName(), [](lua_State * L) {
 			AttachMethods<T> am{L};
 
@@ -456,8 +741,18 @@ template<typename T, typename ... Args> T * New (lua_State * L, Args && ... args
 			lua_setfield(L, -2, td->GetName());	// ..., meta, meta_to_type_data = { ..., [meta] = td, name = nil }
 			lua_pop(L, 1);	// ..., meta
 
-			// Without exception, add a GC metamethod.
-			LuaXS::AttachGC(L, LuaXS::TypedGC<T>);
+			// Without exception, add a GC metamethod. This also settles the heap bookkeeping.
+			LuaXS::AttachGC(L, [](lua_State * L) {
+				auto td = TypeData<T>::Get(L);
+
+				HeapUsage * usage = HeapUsage::Get(L);
+
+				if (usage) usage->Remove(td, LuaXS::UD<T>(L, 1));
+
+				if (td->mLiveCount) --td->mLiveCount;
+
+				return LuaXS::TypedGC<T>(L);
+			});
 
 			// Add a type name getter method, allowing for interal queries for the type key.
 			lua_pushstring(L, td->GetName());	// ..., meta, name
@@ -470,6 +765,12 @@ template<typename T, typename ... Args> T * New (lua_State * L, Args && ... args
 		});
 	}
 
+	// Account for the object's heap memory, possibly stepping the collector. A recycled buffer
+	// whose size is unchanged involved no allocation, so it adds no pressure.
+	size_t bytes = HeapBytes<T>::Get(*object);
+
+	if (usage) usage->Add(L, td, object, bytes, bRecycled && bytes == before ? 0U : bytes);
+
 	// If caching is active, register the object for later reclamation.
 	lua_getref(L, td->mCacheFuncRef);	// ..., object, CacheFunc
 	lua_pushliteral(L, "register");	// ..., object, CacheFunc, "register"
@@ -614,6 +915,106 @@ template<typename R, bool bRow> struct VectorRef {
 // Column vectors are used pervasively, so alias them.
 template<typename R> using ColumnVector = VectorRef<R, false>;
 
+// Structure a matrix, map, or block as a matrix via Eigen's Ref type. When the object's storage
+// is compatible, no copy is made; otherwise, the object is resolved to a temporary.
+template<typename R> struct MatrixRef {
+	using Type = Eigen::Ref<const R, 0, Eigen::OuterStride<>>;
+
+	std::unique_ptr<Type> mRef;	// Reference to the object's storage, or the temporary
+	R mTemp;// Temporary used when the storage is incompatible
+	bool mChanged;	// Did we have to resort to a temporary?
+
+	bool Changed (void) const { return mChanged; }
+
+	const Type & operator * (void) const
+	{
+		return *mRef;
+	}
+
+	const Type * operator -> (void) const
+	{
+		return mRef.get();
+	}
+
+	// Allow stashing in data structures.
+	MatrixRef (void) = default;
+
+	// Bind a matrix, possibly via a temporary.
+	void Init (lua_State * L, int arg = 1)
+	{
+		mChanged = false;
+
+		if (HasType<R>(L, arg)) mRef.reset(new Type{*LuaXS::UD<R>(L, arg)});
+		else if (HasType<Eigen::Map<R>>(L, arg)) mRef.reset(new Type{*LuaXS::UD<Eigen::Map<R>>(L, arg)});
+		else if (HasType<Eigen::Map<const R>>(L, arg)) mRef.reset(new Type{*LuaXS::UD<Eigen::Map<const R>>(L, arg)});
+		else if (HasType<Eigen::Block<R>>(L, arg)) mRef.reset(new Type{*LuaXS::UD<Eigen::Block<R>>(L, arg)});
+		else
+		{
+			mTemp = GetInstanceEx<R>(L, arg);
+			mChanged = true;
+
+			mRef.reset(new Type{mTemp});
+		}
+	}
+
+	MatrixRef (lua_State * L, int arg = 1)
+	{
+		Init(L, arg);
+	}
+};
+
+// Variant of MatrixRef for objects that will be written in place. There is no fallback to a
+// temporary, so the object must be a matrix, non-const map, or block of a matrix.
+template<typename R> struct WritableMatrixRef {
+	using Type = Eigen::Ref<R, 0, Eigen::OuterStride<>>;
+
+	std::unique_ptr<Type> mRef;	// Reference to the object's storage, or to the staging matrix
+	std::unique_ptr<R> mStaged;	// Contiguous copy of a strided view, if one was bound
+	ComponentMap<R> * mComponents{nullptr};	// Strided view to receive the staged results
+
+	Type & operator * (void)
+	{
+		return *mRef;
+	}
+
+	Type * operator -> (void)
+	{
+		return mRef.get();
+	}
+
+	// Allow stashing in data structures.
+	WritableMatrixRef (void) = default;
+
+	// Bind a matrix, which must be writable. Views of complex components have an inner stride,
+	// so are staged through a contiguous copy, written back once the reference goes away.
+	void Init (lua_State * L, int arg = 1)
+	{
+		if (HasType<R>(L, arg)) mRef.reset(new Type{*LuaXS::UD<R>(L, arg)});
+		else if (HasType<Eigen::Map<R>>(L, arg)) mRef.reset(new Type{*LuaXS::UD<Eigen::Map<R>>(L, arg)});
+		else if (HasType<Eigen::Block<R>>(L, arg)) mRef.reset(new Type{*LuaXS::UD<Eigen::Block<R>>(L, arg)});
+
+		else if (HasType<ComponentMap<R>>(L, arg))
+		{
+			mComponents = LuaXS::UD<ComponentMap<R>>(L, arg);
+
+			mStaged.reset(new R{*mComponents});
+			mRef.reset(new Type{*mStaged});
+		}
+
+		else luaL_argerror(L, arg, "Object cannot be written in place");
+	}
+
+	WritableMatrixRef (lua_State * L, int arg = 1)
+	{
+		Init(L, arg);
+	}
+
+	~WritableMatrixRef (void)
+	{
+		if (mComponents) *mComponents = *mStaged;
+	}
+};
+
 // Acquire an instance whose exact type is expected.
 template<typename T> T * GetInstance (lua_State * L, int arg)
 {
@@ -835,6 +1236,22 @@ template<> struct AuxTypeName<std::complex<double>> {
 	AuxTypeName (luaL_Buffer * B, lua_State *) { luaL_addstring(B, "cdouble"); }
 };
 
+template<> struct AuxTypeName<int64_t> {
+	AuxTypeName (luaL_Buffer * B, lua_State *) { luaL_addstring(B, "int64"); }
+};
+
+template<> struct AuxTypeName<int16_t> {
+	AuxTypeName (luaL_Buffer * B, lua_State *) { luaL_addstring(B, "int16"); }
+};
+
+template<> struct AuxTypeName<uint8_t> {
+	AuxTypeName (luaL_Buffer * B, lua_State *) { luaL_addstring(B, "uint8"); }
+};
+
+template<> struct AuxTypeName<Eigen::half> {
+	AuxTypeName (luaL_Buffer * B, lua_State *) { luaL_addstring(B, "half"); }
+};
+
 void AddComma (luaL_Buffer * B)
 {
 	luaL_addstring(B, ", ");
@@ -86,10 +86,42 @@ template<typename T, bool = Eigen::NumTraits<typename T::Scalar>::IsComplex> str
     }
 };
 
+template<typename S> struct AuxAsReal {
+    static S Do (lua_State * L, int arg)
+    {
+        return LuaXS::GetArg<S>(L, arg);
+    }
+};
+
+// Compact integers are fetched as numbers and truncated to the storage type, which must be
+// able to represent them. (The bounds are compared as doubles, so the extreme int64 values are
+// approximate, but the conversion is never out of range.)
+template<typename S> struct AuxAsCompactInteger {
+    static S Do (lua_State * L, int arg)
+    {
+        double n = luaL_checknumber(L, arg);
+
+        luaL_argcheck(L, n > double((std::numeric_limits<S>::min)()) - 1 && n < double((std::numeric_limits<S>::max)()) + 1, arg, "Number out of range for integer type");
+
+        return static_cast<S>(n);
+    }
+};
+
+template<> struct AuxAsReal<int64_t> : AuxAsCompactInteger<int64_t> {};
+template<> struct AuxAsReal<int16_t> : AuxAsCompactInteger<int16_t> {};
+template<> struct AuxAsReal<uint8_t> : AuxAsCompactInteger<uint8_t> {};
+
+template<> struct AuxAsReal<Eigen::half> {
+    static Eigen::half Do (lua_State * L, int arg)
+    {
+        return Eigen::half(float(luaL_checknumber(L, arg)));
+    }
+};
+
 template<typename T> struct AuxAsScalar<T, false> {
     static typename T::Scalar Do (lua_State * L, int arg)
     {
-        return LuaXS::GetArg<typename T::Scalar>(L, arg);
+        return AuxAsReal<typename T::Scalar>::Do(L, arg);
     }
 };
 
@@ -117,12 +149,44 @@ template<typename T> int Call (lua_State * L)
 	return LuaXS::PushArgAndReturn(L, result);
 }
 
+// Type in which coefficients are printed. Byte-sized integers would otherwise come out as characters.
+template<typename S> struct PrintAs {
+	using Type = S;
+};
+
+template<> struct PrintAs<uint8_t> {
+	using Type = int;
+};
+
+template<> struct PrintAs<Eigen::half> {
+	using Type = float;
+};
+
+// Export a matrix's coefficients as a byte string, in the order consumed by setFromBytes(),
+// i.e. by rows.
+template<typename T> int AsBytes (lua_State * L)
+{
+	const T & m = *GetInstance<T>(L);
+	std::vector<typename T::Scalar> coeffs;
+
+	coeffs.reserve(size_t(m.size()));
+
+	for (Eigen::Index i = 0; i < m.rows(); ++i)
+	{
+		for (Eigen::Index j = 0; j < m.cols(); ++j) coeffs.push_back(m.coeff(i, j));
+	}
+
+	lua_pushlstring(L, reinterpret_cast<const char *>(coeffs.data()), coeffs.size() * sizeof(typename T::Scalar));	// m, bytes
+
+	return 1;
+}
+
 // Convert a matrix to a pretty-printed string, e.g. for use by __tostring.
 template<typename T> int Print (lua_State * L, const T & m)
 {
 	std::stringstream ss;
 
-	ss << m;
+	ss << m.template cast<typename PrintAs<typename T::Scalar>::Type>();
 
 	lua_pushstring(L, ss.str().c_str());// m, str
 
@@ -165,6 +229,28 @@ template<> inline void LuaXS::PushArg<std::complex<float>> (lua_State * L, std::
 	LuaXS::PushArg(L, std::complex<double>{c.real(), c.imag()});
 }
 
+// Likewise for the compact integer types, which travel through Lua as numbers. (Exact int64
+// values beyond 2^53 need the byte-level routines, i.e. asBytes() and setFromBytes().)
+template<> inline void LuaXS::PushArg<int64_t> (lua_State * L, int64_t i)
+{
+	lua_pushnumber(L, lua_Number(i));	// ..., i
+}
+
+template<> inline void LuaXS::PushArg<int16_t> (lua_State * L, int16_t i)
+{
+	lua_pushinteger(L, i);	// ..., i
+}
+
+template<> inline void LuaXS::PushArg<uint8_t> (lua_State * L, uint8_t i)
+{
+	lua_pushinteger(L, i);	// ..., i
+}
+
+template<> inline void LuaXS::PushArg<Eigen::half> (lua_State * L, Eigen::half h)
+{
+	lua_pushnumber(L, static_cast<float>(h));	// ..., h
+}
+
 // Customizes SetTemp()'s early-out behavior.
 template<typename R, bool bSetTemp> struct EarlyOut {
 	static R * Do (lua_State * L, int arg, R *)
@@ -226,6 +312,18 @@ template<typename R, bool bSetTemp> R * SetTemp (lua_State * L, R * temp, int ar
 		case eCdouble:
 			lua_pushliteral(L, "cdouble");	// ..., cast, other, "cdouble"
 			break;
+		case eInt64:
+			lua_pushliteral(L, "int64");// ..., cast, other, "int64"
+			break;
+		case eInt16:
+			lua_pushliteral(L, "int16");// ..., cast, other, "int16"
+			break;
+		case eUint8:
+			lua_pushliteral(L, "uint8");// ..., cast, other, "uint8"
+			break;
+		case eHalf:
+			lua_pushliteral(L, "half");	// ..., cast, other, "half"
+			break;
 		default:
 			luaL_error(L, "Unsupported type");
 		}
@@ -26,6 +26,9 @@
 #include "stdafx.h"
 #include "macros.h"
 #include "types.h"
+#include "sort_ops.h"
+#include "statistics.h"
+#include "write_ops.h"
 
 //
 template<typename U, int Dir> struct Nested<Eigen::VectorwiseOp<U, Dir>> {
@@ -41,6 +44,20 @@ template<typename T, typename R, bool = IsBasicVectorwise<T>::value> struct Vect
 template<typename T, typename R> struct VectorwiseWriteOpsGetters<T, R, false> : TempInstanceGetters<T, R> {};
 
 namespace details_vw {
+    // The vectors along which ordering methods run: columns for colwise(), rows for rowwise().
+    template<typename U, int Dir, typename R> struct Lanes {
+        enum { kScalar = false };
+
+        const U & mExpr;
+
+        Lanes (lua_State * L) : mExpr(InstanceGetters<Eigen::VectorwiseOp<U, Dir>, R>::GetT(L)->_expression())
+        {
+        }
+
+        const U & Get (void) const { return mExpr; }
+        bool Rowwise (void) const { return Eigen::VectorwiseOp<U, Dir>::isHorizontal; }
+    };
+
     // Add some methods when the underlying type is real.
     template<typename U, int Dir, typename R, bool = !Eigen::NumTraits<typename R::Scalar>::IsComplex> struct NonComplex {
         using Getters = InstanceGetters<Eigen::VectorwiseOp<U, Dir>, R>;
@@ -57,13 +74,82 @@ namespace details_vw {
             };
         
             luaL_register(L, nullptr, methods);
+
+            AddSortMethods<R, Lanes<U, Dir, R>> sort_methods{L};
         }
     };
     
     template<typename U, int Dir, typename R> struct NonComplex<U, Dir, R, false> {
         NonComplex (lua_State *) {}
     };
+
+    // Add one-pass statistics when the underlying type is real floating point. The vectors being
+    // reduced are the variables, e.g. the columns for colwise(), and the others the observations.
+    template<typename U, int Dir, typename R, bool = !Eigen::NumTraits<typename R::Scalar>::IsInteger && !Eigen::NumTraits<typename R::Scalar>::IsComplex> struct Statistics {
+        using Getters = InstanceGetters<Eigen::VectorwiseOp<U, Dir>, R>;
+        using Accumulator = StatisticsAccumulator<R>;
+
+        // Accumulate the statistics, checking that enough observations are present for the
+        // divisor, as with the accumulator's own methods.
+        static Accumulator Accumulate (lua_State * L, bool bFull, bool bPopulation)
+        {
+            const U & m = Getters::GetT(L)->_expression();
+            bool bVertical = Eigen::VectorwiseOp<U, Dir>::isVertical;
+            Accumulator acc{bVertical ? m.cols() : m.rows(), bFull};
+
+            if (bVertical) acc.Add(m);
+            else acc.Add(m.transpose());
+
+            AttachMethods<Accumulator, R>::CheckCount(L, acc, bPopulation);
+
+            return acc;
+        }
+
+        Statistics (lua_State * L)
+        {
+            luaL_Reg methods[] = {
+                {
+                    "correlation", [](lua_State * L)
+                    {
+                        return NewRet<R>(L, Accumulate(L, true, false).correlation());	// vw, corr
+                    }
+                }, {
+                    "covariance", [](lua_State * L)
+                    {
+                        bool bPopulation = WantsBool(L, "Population", 2);
+
+                        return NewRet<R>(L, Accumulate(L, true, bPopulation).covariance(bPopulation));	// vw[, how], cov
+                    }
+                }, {
+                    "variance", [](lua_State * L)
+                    {
+                        bool bPopulation = WantsBool(L, "Population", 2);
+                        auto var = Accumulate(L, false, bPopulation).variance(bPopulation);
+
+                        if (Eigen::VectorwiseOp<U, Dir>::isVertical) return NewRet<R>(L, var.transpose());	// vw[, how], var
+                        else return NewRet<R>(L, var);	// vw[, how], var
+                    }
+                },
+                { nullptr, nullptr }
+            };
+
+            luaL_register(L, nullptr, methods);
+        }
+    };
+
+    template<typename U, int Dir, typename R> struct Statistics<U, Dir, R, false> {
+        Statistics (lua_State *) {}
+    };
     
+    // Reach the expression beneath the view, for coefficient-wise updates that do not depend on
+    // the direction. This is only used when that expression is an lvalue.
+    template<typename U, int Dir, typename R> struct ExpressionGetters {
+        static U * GetT (lua_State * L)
+        {
+            return &const_cast<U &>(InstanceGetters<Eigen::VectorwiseOp<U, Dir>, R>::GetT(L)->_expression());
+        }
+    };
+
     //
     template<typename U, int Dir, typename R, bool = IsLvalue<U>::value> struct NumericalWriteOps {
         using VR = VectorRef<R, Eigen::VectorwiseOp<U, Dir>::isHorizontal>;
@@ -93,6 +179,9 @@ namespace details_vw {
             };
             
             luaL_register(L, nullptr, methods);
+
+            AddCwiseInPlace<U, R, ExpressionGetters<U, Dir, R>> acip{L};
+            AddRealInPlace<U, R, ExpressionGetters<U, Dir, R>> arip{L};
         }
     };
     
@@ -152,6 +241,7 @@ namespace details_vw {
         
             NonComplex<U, Dir, R> nc{L};
             NumericalWriteOps<U, Dir, R> nwo{L};
+            Statistics<U, Dir, R> stats{L};
         }
     };
 
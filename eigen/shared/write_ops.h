@@ -191,7 +191,18 @@ template<typename T> struct ResizeState {
                                                                                             \
                                     return 0
 
+// Common form of in-place coefficient-wise methods. Results are cast back to the scalar type,
+// e.g. for the real-valued absolute value of a complex matrix.
+#define EIGEN_CWISE_IN_PLACE(EXPR)	auto t = Getters::GetT(L);								\
+                                    auto & m = *t;											\
+                                                                                            \
+                                    m = (EXPR).template cast<Scalar>();						\
+                                                                                            \
+                                    return SelfForChaining(L)
+
 //
+#define EIGEN_ARRAY_IN_PLACE_METHOD(NAME) EIGEN_REG(NAME##InPlace, EIGEN_CWISE_IN_PLACE(m.array().NAME().matrix()))
+#define EIGEN_MATRIX_IN_PLACE_METHOD(NAME) EIGEN_REG(NAME##InPlace, EIGEN_CWISE_IN_PLACE(m.NAME()))
 #define COEFF_MUTATE_METHOD(NAME, OP) EIGEN_REG(NAME, COEFF_MUTATE(OP))
 #define EIGEN_MATRIX_RESIZE_METHOD(NAME) EIGEN_REG(NAME, EIGEN_MATRIX_RESIZE(NAME))
 
@@ -258,6 +269,92 @@ template<typename T, typename R> struct AddMatrix<T, R, false> {
     }
 };
 
+// In-place counterparts of the unary coefficient-wise methods, available to any non-boolean type.
+// The getters may be overridden, e.g. to reach the expression beneath a vectorwise view.
+template<typename T, typename R, typename G = WriteOpsGetters<T, R>> struct AddCwiseInPlace {
+    using Getters = G;
+    using Scalar = typename R::Scalar;
+
+    AddCwiseInPlace (lua_State * L)
+    {
+        luaL_Reg methods[] = {
+            {
+                EIGEN_ARRAY_IN_PLACE_METHOD(acos)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(arg)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(asin)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(atan)
+            }, {
+                EIGEN_MATRIX_IN_PLACE_METHOD(conjugate)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(cos)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(cosh)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(cube)
+            }, {
+                EIGEN_MATRIX_IN_PLACE_METHOD(cwiseAbs)
+            }, {
+                EIGEN_MATRIX_IN_PLACE_METHOD(cwiseAbs2)
+            }, {
+                EIGEN_MATRIX_IN_PLACE_METHOD(cwiseInverse)
+            }, {
+                EIGEN_MATRIX_IN_PLACE_METHOD(cwiseSign)
+            }, {
+                EIGEN_MATRIX_IN_PLACE_METHOD(cwiseSqrt)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(exp)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(log)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(log10)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(sin)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(sinh)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(square)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(tan)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(tanh)
+            },
+            { nullptr, nullptr }
+        };
+
+        luaL_register(L, nullptr, methods);
+    }
+};
+
+// In-place counterparts of the rounding methods, when the underlying type is real.
+template<typename T, typename R, typename G = WriteOpsGetters<T, R>, bool = !Eigen::NumTraits<typename R::Scalar>::IsComplex> struct AddRealInPlace {
+    using Getters = G;
+    using Scalar = typename R::Scalar;
+
+    AddRealInPlace (lua_State * L)
+    {
+        luaL_Reg methods[] = {
+            {
+                EIGEN_ARRAY_IN_PLACE_METHOD(ceil)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(floor)
+            }, {
+                EIGEN_ARRAY_IN_PLACE_METHOD(round)
+            },
+            { nullptr, nullptr }
+        };
+
+        luaL_register(L, nullptr, methods);
+    }
+};
+
+// No-op for complex types.
+template<typename T, typename R, typename G> struct AddRealInPlace<T, R, G, false> {
+    AddRealInPlace (lua_State *) {}
+};
+
 //
 template<typename T, typename R> struct AddNonBool {
     using Getters = WriteOpsGetters<T, R>;
@@ -344,6 +441,9 @@ template<typename T, typename R> struct AddNonBool {
         };
     
         luaL_register(L, nullptr, methods);
+
+        AddCwiseInPlace<T, R> acip{L};
+        AddRealInPlace<T, R> arip{L};
     }
 };
 